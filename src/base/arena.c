@@ -0,0 +1,183 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** A BlobArena is a region allocator for Blobs.  Blobs initialized with
+** blob_init_arena() grow out of large bump-allocated chunks instead of
+** calling malloc()/realloc()/free() for every resize, and all of them
+** are released at once by blob_arena_reset().
+*/
+
+#include "fslbase.h"
+
+typedef long long int i64;
+
+/*
+** A single chunk of arena memory.  The usable space follows the
+** header.
+*/
+struct BlobArenaChunk {
+  BlobArenaChunk *pNext;         /* Next older chunk */
+  blob_size_t nSize;             /* Bytes of usable space in this chunk */
+  blob_size_t nUsed;             /* Bytes of usable space handed out */
+};
+
+/*
+** All sizes handed out by the arena are multiples of ARENA_ALIGN.
+*/
+#define ARENA_ALIGN      8
+#define ARENA_ROUND(N)   (((N)+ARENA_ALIGN-1) & ~(i64)(ARENA_ALIGN-1))
+
+/*
+** Every block starts with a pointer back to the arena that owns it,
+** so that blobReallocArena() can find the arena given nothing more
+** than Blob.aData.  ARENA_HDR is the size of that header.
+*/
+#define ARENA_HDR        ARENA_ROUND(sizeof(BlobArena*))
+#define arenaOf(Z)       (((BlobArena**)(Z))[-1])
+
+/*
+** Space in a chunk starts right after the (aligned) chunk header.
+*/
+#define arenaChunkData(C) ((char*)(C) + ARENA_ROUND(sizeof(BlobArenaChunk)))
+
+/*
+** Prepare an arena for use.  Chunks are szChunk bytes in size, or
+** BLOB_ARENA_CHUNK bytes if szChunk is zero.  No memory is allocated
+** until the first Blob is initialized.
+*/
+void blob_arena_init(BlobArena *p, unsigned int szChunk){
+  p->pChunk = 0;
+  p->szChunk = szChunk ? szChunk : BLOB_ARENA_CHUNK;
+  p->nMalloc = 0;
+}
+
+/*
+** Carve nByte bytes (already a multiple of ARENA_ALIGN) out of the
+** arena.  A new chunk is obtained from fossil_malloc() if the current
+** one is full.  Requests larger than a chunk get a chunk of their own.
+*/
+static char *arenaAlloc(BlobArena *p, i64 nByte){
+  BlobArenaChunk *pChunk = p->pChunk;
+  i64 nNeed = ARENA_HDR + nByte;
+  char *z;
+  if( pChunk==0 || pChunk->nUsed + nNeed > pChunk->nSize ){
+    i64 nSize = p->szChunk;
+    if( nSize<nNeed ) nSize = nNeed;
+    pChunk = fossil_malloc( ARENA_ROUND(sizeof(BlobArenaChunk)) + nSize );
+    pChunk->nSize = (blob_size_t)nSize;
+    pChunk->nUsed = 0;
+    pChunk->pNext = p->pChunk;
+    p->pChunk = pChunk;
+    p->nMalloc++;
+  }
+  z = arenaChunkData(pChunk) + pChunk->nUsed + ARENA_HDR;
+  arenaOf(z) = p;
+  pChunk->nUsed += (blob_size_t)nNeed;
+  return z;
+}
+
+/*
+** Initialize a blob so that its content is allocated from arena p.
+** Any prior content of the blob is discarded, not freed.
+*/
+void blob_init_arena(Blob *pBlob, BlobArena *p){
+  assert_blob_is_reset(pBlob);
+  pBlob->aData = arenaAlloc(p, ARENA_ALIGN);
+  pBlob->aData[0] = 0;
+  pBlob->nUsed = 0;
+  pBlob->nAlloc = ARENA_ALIGN;
+  pBlob->iCursor = 0;
+  pBlob->blobFlags = 0;
+  pBlob->xRealloc = blobReallocArena;
+}
+
+/*
+** Return nByte bytes of arena memory, aligned to 8 bytes.  The memory
+** is released with the rest of the arena by blob_arena_reset().
+*/
+void *blob_arena_alloc(BlobArena *p, blob_size_t nByte){
+  return arenaAlloc(p, ARENA_ROUND((i64)nByte));
+}
+
+/*
+** A reallocation function for blobs whose aData lives in an arena.
+**
+** A blob that owns the most recent block of the current chunk grows
+** and shrinks in place.  Otherwise a larger request copies the content
+** into a new block and leaves the old one to be reclaimed by the next
+** blob_arena_reset().  A newSize of 0 empties the blob but keeps it
+** attached to its arena.
+*/
+void blobReallocArena(Blob *pBlob, blob_size_t newSize){
+  BlobArena *p = arenaOf(pBlob->aData);
+  BlobArenaChunk *pChunk = p->pChunk;
+  i64 nNew = ARENA_ROUND((i64)newSize);
+  int isLast;
+  char *pNew;
+
+  isLast = pBlob->aData + pBlob->nAlloc
+             == arenaChunkData(pChunk) + pChunk->nUsed;
+  if( newSize==0 ){
+    nNew = ARENA_ALIGN;
+    pBlob->nUsed = 0;
+    pBlob->iCursor = 0;
+    pBlob->blobFlags = 0;
+    pBlob->aData[0] = 0;
+  }
+  if( nNew<=pBlob->nAlloc ){
+    if( isLast ){
+      pChunk->nUsed -= pBlob->nAlloc - (blob_size_t)nNew;
+      pBlob->nAlloc = (blob_size_t)nNew;
+    }
+  }else if( isLast && pChunk->nUsed + (nNew - pBlob->nAlloc)<=pChunk->nSize ){
+    pChunk->nUsed += (blob_size_t)nNew - pBlob->nAlloc;
+    pBlob->nAlloc = (blob_size_t)nNew;
+  }else{
+    pNew = arenaAlloc(p, nNew);
+    memcpy(pNew, pBlob->aData, pBlob->nUsed);
+    pBlob->aData = pNew;
+    pBlob->nAlloc = (blob_size_t)nNew;
+  }
+  if( pBlob->nUsed>pBlob->nAlloc ){
+    pBlob->nUsed = pBlob->nAlloc;
+  }
+}
+
+/*
+** Release every blob allocated from arena p.  The most recent chunk is
+** kept for reuse, all others are freed.  Blobs that were allocated from
+** the arena must not be used again until re-initialized.
+*/
+void blob_arena_reset(BlobArena *p){
+  BlobArenaChunk *pChunk = p->pChunk;
+  BlobArenaChunk *pNext;
+  if( pChunk==0 ) return;
+  pNext = pChunk->pNext;
+  pChunk->pNext = 0;
+  pChunk->nUsed = 0;
+  while( pNext ){
+    pChunk = pNext;
+    pNext = pChunk->pNext;
+    fossil_free(pChunk);
+  }
+}
+
+/*
+** Release every blob allocated from arena p and return all of the
+** arena memory to the system.
+*/
+void blob_arena_free(BlobArena *p){
+  blob_arena_reset(p);
+  fossil_free(p->pChunk);
+  p->pChunk = 0;
+}
@@ -40,13 +40,6 @@ static void blob_panic(void){
 #endif /* libfsl */
 }
 
-/*
-** Maximum size of a Blob's managed memory. This is ~2GB, largely for
-** historical reasons.
-**
-*/
-#define MAX_BLOB_SIZE 0x7fff0000
-
 /*
 ** If n >= MAX_BLOB_SIZE, calls blob_panic(),
 ** else this is a no-op.
@@ -57,18 +50,176 @@ static void blob_assert_safe_size(i64 n){
   }
 }
 
+/*
+** Number of size classes of the buffer cache
+*/
+#define BLOB_CACHE_NCLASS  15     /* BLOB_CACHE_MIN<<14 == BLOB_CACHE_MAX */
+
+/*
+** A per-thread cache of blob buffers from malloc().  Free buffers are
+** kept on one list per power-of-two size class, linked through their
+** first bytes.  The cache is off while mxBytes is 0.
+*/
+typedef struct BlobCache BlobCache;
+struct BlobCache {
+  u64 mxBytes;                   /* Most bytes to keep, 0 if the cache is off */
+  BlobCacheStats s;              /* Counters.  s.nCached is bytes kept */
+  void *aFree[BLOB_CACHE_NCLASS];  /* Free buffers of each size class */
+};
+static __thread BlobCache blobCache;
+
+/*
+** Return the size class of a buffer of at least n bytes, or -1 if the
+** cache is off or n is more than BLOB_CACHE_MAX.
+*/
+static int blobCacheClass(u64 n){
+  if( blobCache.mxBytes==0 || n>BLOB_CACHE_MAX ) return -1;
+  if( n<=BLOB_CACHE_MIN ) return 0;
+  return 64 - __builtin_clzll(n-1) - 6;
+}
+
+/*
+** Round n up to its size class while the cache is on.
+*/
+static blob_size_t blobCacheRound(blob_size_t n){
+  int k = blobCacheClass(n);
+  return k<0 ? n : (blob_size_t)BLOB_CACHE_MIN<<k;
+}
+
+/*
+** Return a buffer of at least *pnAlloc bytes and store its size in
+** *pnAlloc.  The buffer comes from the cache if it can.
+*/
+static char *blobCacheGet(blob_size_t *pnAlloc){
+  BlobCache *c = &blobCache;
+  int k = blobCacheClass(*pnAlloc);
+  char *p;
+  if( k<0 ) return fossil_malloc( *pnAlloc );
+  *pnAlloc = (blob_size_t)BLOB_CACHE_MIN<<k;
+  if( (p = c->aFree[k])!=0 ){
+    c->aFree[k] = *(void**)p;
+    c->s.nCached -= *pnAlloc;
+    c->s.nHit++;
+    return p;
+  }
+  c->s.nMalloc++;
+  return fossil_malloc( *pnAlloc );
+}
+
+/*
+** Give up a buffer of nAlloc bytes.  It is kept by the cache if its size
+** is a size class and the cache has room for it, else freed.
+*/
+static void blobCachePut(char *p, blob_size_t nAlloc){
+  BlobCache *c = &blobCache;
+  int k = blobCacheClass(nAlloc);
+  if( k<0 ){
+    free(p);
+  }else if( nAlloc!=(blob_size_t)BLOB_CACHE_MIN<<k
+         || c->s.nCached + nAlloc > c->mxBytes ){
+    c->s.nFree++;
+    free(p);
+  }else{
+    *(void**)p = c->aFree[k];
+    c->aFree[k] = p;
+    c->s.nCached += nAlloc;
+  }
+}
+
+/*
+** Memory accounting.  Buffers from malloc() held by blobs are counted
+** against the category that was current on the thread which allocated
+** them.  The category is kept in the blobFlags of the blob so that the
+** buffer is credited back to it when freed, on whichever thread.
+*/
+static int blobAcctOn = 0;                 /* True once enabled */
+static BlobBudgetFunc xBlobBudget = 0;      /* Budget callback */
+static void *pBlobBudgetArg = 0;           /* Its first argument */
+static BlobAccount aBlobAcct[BLOB_ACCOUNT_NCAT];
+static __thread int iBlobAcctCat = 0;      /* Category of new buffers */
+
+/*
+** Called when the bytes held in category iCat are about to grow from
+** nCur by nMore and cross a budget.  Give the callback a chance to
+** release memory or raise the budget.  Return 1 if the callback refuses
+** the allocation with BLOB_BUDGET_FAIL.  Past the hard budget the
+** program exits otherwise.
+*/
+static int blobOverBudget(int iCat, u64 nCur, u64 nMore){
+  BlobAccount *a = &aBlobAcct[iCat];
+  u64 mxSoft = __atomic_load_n(&a->mxSoft, __ATOMIC_RELAXED);
+  if( mxSoft && nCur<=mxSoft && nCur+nMore>mxSoft && xBlobBudget ){
+    xBlobBudget(pBlobBudgetArg, iCat, BLOB_BUDGET_SOFT, nCur, nMore);
+  }
+  for(;;){
+    u64 mxHard = __atomic_load_n(&a->mxHard, __ATOMIC_RELAXED);
+    int rc;
+    nCur = __atomic_load_n(&a->nCur, __ATOMIC_RELAXED);
+    if( mxHard==0 || nCur+nMore<=mxHard ) return 0;
+    if( xBlobBudget==0 ) break;
+    rc = xBlobBudget(pBlobBudgetArg, iCat, BLOB_BUDGET_HARD, nCur, nMore);
+    if( rc==BLOB_BUDGET_FAIL ) return 1;
+    if( rc==0 ) break;
+  }
+  fputs("memory budget exceeded\n", stderr);
+  exit(1);
+}
+
+/*
+** The buffer of pBlob, counted or not, is about to become nNew bytes
+** from malloc(), or to be freed if nNew is 0.  Update the counters.
+** Return 1, with BLOBFLAG_OverBudget set and nothing counted, if the
+** growth is refused.  The caller must then leave the blob unchanged.
+*/
+static int blobAccount(Blob *pBlob, blob_size_t nNew){
+  BlobAccount *a;
+  u64 nOld = 0, nCur, nPeak;
+  int iCat;
+  if( pBlob->blobFlags & BLOBFLAG_Account ){
+    iCat = (pBlob->blobFlags & BLOBFLAG_Category)>>BLOBFLAG_CATEGORY_SHIFT;
+    nOld = pBlob->nAlloc;
+  }else{
+    if( !blobAcctOn || nNew==0 ) return 0;
+    iCat = iBlobAcctCat;
+  }
+  a = &aBlobAcct[iCat];
+  if( nNew>nOld ){
+    nCur = __atomic_load_n(&a->nCur, __ATOMIC_RELAXED);
+    if( (a->mxSoft || a->mxHard) && blobOverBudget(iCat, nCur, nNew-nOld) ){
+      pBlob->blobFlags |= BLOBFLAG_OverBudget;
+      return 1;
+    }
+    nCur = __atomic_add_fetch(&a->nCur, nNew-nOld, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&a->nAlloc, 1, __ATOMIC_RELAXED);
+    nPeak = __atomic_load_n(&a->nPeak, __ATOMIC_RELAXED);
+    while( nCur>nPeak
+        && !__atomic_compare_exchange_n(&a->nPeak, &nPeak, nCur, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED) ){}
+  }else{
+    __atomic_sub_fetch(&a->nCur, nOld-nNew, __ATOMIC_RELAXED);
+  }
+  pBlob->blobFlags &= ~(BLOBFLAG_Account|BLOBFLAG_Category);
+  if( nNew>0 ){
+    pBlob->blobFlags |= BLOBFLAG_Account
+                      | (unsigned int)iCat<<BLOBFLAG_CATEGORY_SHIFT;
+  }
+  return 0;
+}
+
 /*
 ** A reallocation function for when the initial string is in unmanaged
 ** space.  Copy the string to memory obtained from malloc().
 */
-static void blobReallocStatic(Blob *pBlob, unsigned int newSize){
+static void blobReallocStatic(Blob *pBlob, blob_size_t newSize){
   if( newSize==0 ){
     *pBlob = empty_blob;
   }else{
     char *pNew;
     blob_assert_safe_size((i64)newSize);
-    pNew = fossil_malloc( newSize );
+    newSize = blobCacheRound(newSize);
+    if( blobAccount(pBlob, newSize) ) return;
     if( pBlob->nUsed>newSize ) pBlob->nUsed = newSize;
+    pNew = blobCacheGet(&newSize);
     memcpy(pNew, pBlob->aData, pBlob->nUsed);
     pBlob->aData = pNew;
     pBlob->xRealloc = blobReallocMalloc;
@@ -76,21 +227,194 @@ static void blobReallocStatic(Blob *pBlob, unsigned int newSize){
   }
 }
 
+/*
+** A reallocation function for blobs whose initial buffer was supplied
+** by the caller through blob_init_inline().  The buffer is used as long
+** as the content fits.  Growing past it moves the content to memory from
+** malloc().  A newSize of 0 empties the blob and keeps the buffer.
+*/
+void blobReallocInline(Blob *pBlob, blob_size_t newSize){
+  if( newSize==0 ){
+    pBlob->nUsed = 0;
+    pBlob->iCursor = 0;
+    pBlob->blobFlags = 0;
+    pBlob->aData[0] = 0;
+  }else if( newSize<=pBlob->nAlloc ){
+    if( pBlob->nUsed>newSize ) pBlob->nUsed = newSize;
+  }else{
+    char *pNew;
+    blob_assert_safe_size((i64)newSize);
+    newSize = blobCacheRound(newSize);
+    if( blobAccount(pBlob, newSize) ) return;
+    pNew = blobCacheGet(&newSize);
+    memcpy(pNew, pBlob->aData, pBlob->nUsed);
+    pBlob->aData = pNew;
+    pBlob->xRealloc = blobReallocMalloc;
+    pBlob->nAlloc = newSize;
+  }
+}
+
+/*
+** Growth policies for blob_append().  See BlobGrowFunc.
+**
+** blobGrowDefault() is the historical Fossil policy.  It grows by the
+** current size plus 100 bytes.
+*/
+u64 blobGrowDefault(u64 nAlloc, u64 nNeed){
+  return nNeed + nAlloc + 100;
+}
+
+/*
+** Double the buffer until it is large enough.
+*/
+u64 blobGrowDouble(u64 nAlloc, u64 nNeed){
+  u64 n = nAlloc<64 ? 64 : nAlloc*2;
+  while( n<=nNeed ) n *= 2;
+  return n;
+}
+
+/*
+** Grow the buffer by half of its size until it is large enough.
+*/
+u64 blobGrowOneHalf(u64 nAlloc, u64 nNeed){
+  u64 n = nAlloc<64 ? 64 : nAlloc + nAlloc/2;
+  while( n<=nNeed ) n += n/2;
+  return n;
+}
+
+/*
+** Like blobGrowOneHalf(), but buffers of BLOB_PAGE_SIZE bytes or more
+** are rounded up to a whole number of pages.
+*/
+u64 blobGrowPage(u64 nAlloc, u64 nNeed){
+  u64 n = blobGrowOneHalf(nAlloc, nNeed);
+  if( n>=BLOB_PAGE_SIZE ){
+    n = (n + BLOB_PAGE_SIZE - 1) & ~(u64)(BLOB_PAGE_SIZE - 1);
+  }
+  return n;
+}
+
+/*
+** The growth policy used by blob_append() and friends.
+*/
+static BlobGrowFunc xBlobGrow = blobGrowDefault;
+
+/*
+** Change the growth policy used by all blobs.  A NULL argument
+** restores blobGrowDefault().  Return the previous policy.
+*/
+BlobGrowFunc blob_set_growth(BlobGrowFunc xGrow){
+  BlobGrowFunc xOld = xBlobGrow;
+  xBlobGrow = xGrow ? xGrow : blobGrowDefault;
+  return xOld;
+}
+
+/*
+** Turn on the buffer cache of the calling thread, keeping at most
+** mxBytes bytes of free buffers.  Blobs whose buffers come from malloc()
+** then take them from the cache and give them back to it when reset.
+** An mxBytes of 0 flushes the cache and turns it off.
+**
+** Buffers are rounded up to a power of two while the cache is on.  The
+** cached memory is only released by blob_cache_flush() and
+** blob_cache_enable(0), which a thread must call before it exits.
+*/
+void blob_cache_enable(u64 mxBytes){
+  if( mxBytes<blobCache.s.nCached ) blob_cache_flush();
+  blobCache.mxBytes = mxBytes;
+}
+
+/*
+** Free every buffer kept by the cache of the calling thread.
+*/
+void blob_cache_flush(void){
+  BlobCache *c = &blobCache;
+  int k;
+  for(k=0; k<BLOB_CACHE_NCLASS; k++){
+    while( c->aFree[k] ){
+      void *p = c->aFree[k];
+      c->aFree[k] = *(void**)p;
+      c->s.nFree++;
+      free(p);
+    }
+  }
+  c->s.nCached = 0;
+}
+
+/*
+** Copy the counters of the cache of the calling thread into *p.
+*/
+void blob_cache_stats(BlobCacheStats *p){
+  *p = blobCache.s;
+}
+
+/*
+** Start counting the bytes of blob buffers from malloc(), by category.
+** Buffers allocated before are not counted.  xBudget, if not NULL, is
+** called with pArg when a category crosses its soft budget, and when it
+** would cross its hard budget.  See BlobBudgetFunc.
+*/
+void blob_account_enable(BlobBudgetFunc xBudget, void *pArg){
+  xBlobBudget = xBudget;
+  pBlobBudgetArg = pArg;
+  blobAcctOn = 1;
+}
+
+/*
+** Make iCat the category of the buffers the calling thread allocates
+** from now on.  Return the previous category.
+*/
+int blob_account_category(int iCat){
+  int iOld = iBlobAcctCat;
+  assert( iCat>=0 && iCat<BLOB_ACCOUNT_NCAT );
+  iBlobAcctCat = iCat;
+  return iOld;
+}
+
+/*
+** Set the soft and hard budgets of category iCat, in bytes.  0 means
+** no budget.
+*/
+void blob_account_budget(int iCat, u64 mxSoft, u64 mxHard){
+  assert( iCat>=0 && iCat<BLOB_ACCOUNT_NCAT );
+  __atomic_store_n(&aBlobAcct[iCat].mxSoft, mxSoft, __ATOMIC_RELAXED);
+  __atomic_store_n(&aBlobAcct[iCat].mxHard, mxHard, __ATOMIC_RELAXED);
+}
+
+/*
+** Copy the counters and budgets of category iCat into *p.
+*/
+void blob_account_get(int iCat, BlobAccount *p){
+  BlobAccount *a = &aBlobAcct[iCat];
+  assert( iCat>=0 && iCat<BLOB_ACCOUNT_NCAT );
+  p->nCur = __atomic_load_n(&a->nCur, __ATOMIC_RELAXED);
+  p->nPeak = __atomic_load_n(&a->nPeak, __ATOMIC_RELAXED);
+  p->nAlloc = __atomic_load_n(&a->nAlloc, __ATOMIC_RELAXED);
+  p->mxSoft = __atomic_load_n(&a->mxSoft, __ATOMIC_RELAXED);
+  p->mxHard = __atomic_load_n(&a->mxHard, __ATOMIC_RELAXED);
+}
+
 /*
 ** Return a pointer to a null-terminated string for a blob.
 */
 char *blob_str(Blob *p){
   blob_is_init(p);
+  if( p->xRealloc==blobReallocChain && blob_chain_flatten((BlobChain*)p) ){
+    return blob_materialize(p);
+  }
+  if( p->nUsed==0 && p->nAlloc<=1 ){
+    static char zEmpty[] = "";
+    return zEmpty;   /* libfsl: do not allocate for an empty blob */
+  }
   if( p->nUsed==0 ){
     blob_append_char(p, 0); /* NOTE: Changes nUsed. */
     p->nUsed = 0;
   }
   if( p->nUsed<p->nAlloc ){
     p->aData[p->nUsed] = 0;
-  }else{
-    blob_materialize(p);
+    return p->aData;
   }
-  return p->aData;
+  return blob_materialize(p);
 }
 
 /*
@@ -98,10 +422,120 @@ char *blob_str(Blob *p){
 ** space.  Return a pointer to the data.
 */
 char *blob_materialize(Blob *pBlob){
-  blob_resize(pBlob, pBlob->nUsed);
+  static char zEmpty[] = "";
+  if( (pBlob->xRealloc==blobReallocChain
+       && blob_chain_flatten((BlobChain*)pBlob))
+   || blob_resize(pBlob, pBlob->nUsed) ){
+    return zEmpty;   /* libfsl: the copy was refused, see BLOB_BUDGET_FAIL */
+  }
   return pBlob->aData;
 }
 
+/*
+** Compare two blobs.  Return negative, zero, or positive if the first
+** blob is less then, equal to, or greater than the second.
+**
+** libfsl: the comparison is by length, embedded 0x00 bytes included,
+** and never materializes either blob.
+*/
+int blob_compare(Blob *pA, Blob *pB){
+  blob_size_t szA, szB, sz;
+  int rc;
+  blob_is_init(pA);
+  blob_is_init(pB);
+  szA = blob_size(pA);
+  szB = blob_size(pB);
+  sz = szA<szB ? szA : szB;
+  rc = sz ? memcmp(blob_buffer(pA), blob_buffer(pB), sz) : 0;
+  if( rc==0 ){
+    rc = szA<szB ? -1 : szA>szB;
+  }
+  return rc;
+}
+
+/*
+** Compare a blob to a string.  Return TRUE if they are equal.
+** If n<0 then the string ends at its first 0x00 byte.
+*/
+int blob_eq_str(Blob *pBlob, const char *z, blob_ssize_t n){
+  blob_is_init(pBlob);
+  if( n<0 ) n = strlen(z);
+  return blob_size(pBlob)==(blob_size_t)n
+      && (n==0 || memcmp(blob_buffer(pBlob), z, n)==0);
+}
+
+/*
+** Search the unread part of pBlob, from its cursor to its end, for the
+** nNeedle bytes of zNeedle.  If nNeedle<0 then the needle ends at its
+** first 0x00 byte.  Return the offset of the first match from the start
+** of the blob, or -1 if there is none.  An empty needle matches at the
+** cursor.  The blob is not modified.
+*/
+blob_ssize_t blob_find(Blob *pBlob, const char *zNeedle, blob_ssize_t nNeedle){
+  blob_size_t n, i;
+  blob_is_init(pBlob);
+  if( nNeedle<0 ) nNeedle = strlen(zNeedle);
+  if( pBlob->iCursor>pBlob->nUsed ) return -1;
+  n = pBlob->nUsed - pBlob->iCursor;
+  if( (blob_size_t)nNeedle>n ) return -1;
+  if( nNeedle==0 ) return pBlob->iCursor;
+  i = scan_find(pBlob->aData + pBlob->iCursor, n, zNeedle, nNeedle);
+  return i==n ? -1 : (blob_ssize_t)(pBlob->iCursor + i);
+}
+
+/*
+** Like blob_find() but return the offset of the last match in the
+** unread part of pBlob.  An empty needle matches at the end of the blob.
+*/
+blob_ssize_t blob_find_last(Blob *pBlob, const char *zNeedle,
+                            blob_ssize_t nNeedle){
+  blob_size_t n, i;
+  blob_is_init(pBlob);
+  if( nNeedle<0 ) nNeedle = strlen(zNeedle);
+  if( pBlob->iCursor>pBlob->nUsed ) return -1;
+  n = pBlob->nUsed - pBlob->iCursor;
+  if( (blob_size_t)nNeedle>n ) return -1;
+  if( nNeedle==0 ) return pBlob->nUsed;
+  i = scan_find_last(pBlob->aData + pBlob->iCursor, n, zNeedle, nNeedle);
+  return i==n ? -1 : (blob_ssize_t)(pBlob->iCursor + i);
+}
+
+/*
+** Call the reallocation function of a blob to grow its buffer to
+** newSize bytes.  Return 1 if the growth was refused by a memory budget,
+** see BLOB_BUDGET_FAIL.  The blob is then unchanged, save for
+** BLOBFLAG_OverBudget.
+*/
+static int blobRealloc(Blob *pBlob, blob_size_t newSize){
+  unsigned int f = pBlob->blobFlags & BLOBFLAG_OverBudget;
+  pBlob->blobFlags &= ~BLOBFLAG_OverBudget;
+  pBlob->xRealloc(pBlob, newSize);
+  if( pBlob->blobFlags & BLOBFLAG_OverBudget ) return 1;
+  pBlob->blobFlags |= f;
+  return 0;
+}
+
+/*
+** Grow the buffer of a blob so that it holds more than nNeed bytes.
+** The growth policy is not consulted for chains, which are asked for
+** exactly the space they need.  Return 1 if the growth was refused.
+*/
+static int blobGrow(Blob *pBlob, sqlite3_int64 nNeed){
+  sqlite3_int64 nNew;
+  blob_size_t nMore = (blob_size_t)(nNeed - pBlob->nUsed);
+  if( pBlob->xRealloc==blobReallocChain ){
+    nNew = nNeed + 1;
+  }else{
+    nNew = (sqlite3_int64)xBlobGrow(pBlob->nAlloc, nNeed);
+  }
+  blob_assert_safe_size(nNew);
+  if( blobRealloc(pBlob, (blob_size_t)nNew) ) return 1;
+  if( pBlob->nUsed + nMore >= pBlob->nAlloc ){
+    blob_panic();
+  }
+  return 0;
+}
+
 /*
 ** Append text or data to the end of a blob.  Or, if pBlob==NULL, send
 ** the text to standard output in terminal mode, or to standard CGI output
@@ -114,7 +548,11 @@ char *blob_materialize(Blob *pBlob){
 ** The blob_append() routine automatically calls blob_append_full() if
 ** necessary.
 */
-static void blob_append_full(Blob *pBlob, const char *aData, int nData){
+static void blob_append_full(
+  Blob *pBlob,
+  const char *aData,
+  blob_ssize_t nData
+){
   sqlite3_int64 nNew;
   /* assert( aData!=0 || nData==0 ); // omitted for speed */
   /* blob_is_init(pBlob); // omitted for speed */
@@ -134,15 +572,7 @@ static void blob_append_full(Blob *pBlob, const char *aData, int nData){
   }
   nNew = pBlob->nUsed;
   nNew += nData;
-  if( nNew >= pBlob->nAlloc ){
-    nNew += pBlob->nAlloc;
-    nNew += 100;
-    blob_assert_safe_size(nNew);
-    pBlob->xRealloc(pBlob, (unsigned)nNew);
-    if( pBlob->nUsed + nData >= pBlob->nAlloc ){
-      blob_panic();
-    }
-  }
+  if( nNew >= pBlob->nAlloc && blobGrow(pBlob, nNew) ) return;
   memcpy(&pBlob->aData[pBlob->nUsed], aData, nData);
   pBlob->nUsed += nData;
   pBlob->aData[pBlob->nUsed] = 0;   /* Blobs are always nul-terminated */
@@ -160,7 +590,7 @@ static void blob_append_full(Blob *pBlob, const char *aData, int nData){
 ** The blob_append() routine automatically calls blob_append_full() if
 ** necessary.
 */
-void blob_append(Blob *pBlob, const char *aData, int nData){
+void blob_append(Blob *pBlob, const char *aData, blob_ssize_t nData){
   sqlite3_int64 nUsed;
   /* assert( aData!=0 || nData==0 ); // omitted for speed */
   if( nData<=0 || pBlob==0 || pBlob->nUsed + nData >= pBlob->nAlloc ){
@@ -185,6 +615,24 @@ void blob_append_char(Blob *pBlob, char c){
   }
 }
 
+/*
+** Make room for n more bytes at the end of a blob and return a pointer
+** to them.  The size of the blob grows by n and the caller fills in the
+** new bytes, which saves copying data that is produced in place.
+** Return NULL, with the blob unchanged, if a memory budget refuses the
+** growth.
+*/
+char *blob_append_space(Blob *pBlob, blob_size_t n){
+  sqlite3_int64 nNew = pBlob->nUsed;
+  char *z;
+  nNew += n;
+  if( nNew >= pBlob->nAlloc && blobGrow(pBlob, nNew) ) return 0;
+  z = &pBlob->aData[pBlob->nUsed];
+  pBlob->nUsed += n;
+  pBlob->aData[pBlob->nUsed] = 0;
+  return z;
+}
+
 /*
 ** A reallocation function that assumes that aData came from malloc().
 ** This function attempts to resize the buffer of the blob to hold
@@ -194,9 +642,12 @@ void blob_append_char(Blob *pBlob, char c){
 ** If an OOM error occurs, an error message is printed on stderr
 ** and the program exits.
 */
-void blobReallocMalloc(Blob *pBlob, unsigned int newSize){
+void blobReallocMalloc(Blob *pBlob, blob_size_t newSize){
   if( newSize==0 ){
-    free(pBlob->aData);
+    if( pBlob->aData ){
+      blobAccount(pBlob, 0);
+      blobCachePut(pBlob->aData, pBlob->nAlloc);
+    }
     pBlob->aData = 0;
     pBlob->nAlloc = 0;
     pBlob->nUsed = 0;
@@ -205,7 +656,19 @@ void blobReallocMalloc(Blob *pBlob, unsigned int newSize){
   }else if( newSize>pBlob->nAlloc || newSize+4000<pBlob->nAlloc ){
     char *pNew;
     blob_assert_safe_size((i64)newSize);
-    pNew = fossil_realloc(pBlob->aData, newSize);
+    newSize = blobCacheRound(newSize);
+    if( blobAccount(pBlob, newSize) ) return;
+    if( pBlob->aData==0 || blobCacheClass(newSize)>=0 ){
+      /* libfsl: buffers move through the cache when it is on */
+      blob_size_t n = pBlob->nUsed<newSize ? pBlob->nUsed : newSize;
+      pNew = blobCacheGet(&newSize);
+      if( pBlob->aData ){
+        memcpy(pNew, pBlob->aData, n);
+        blobCachePut(pBlob->aData, pBlob->nAlloc);
+      }
+    }else{
+      pNew = fossil_realloc(pBlob->aData, newSize);
+    }
     pBlob->aData = pNew;
     pBlob->nAlloc = newSize;
     if( pBlob->nUsed>pBlob->nAlloc ){
@@ -217,11 +680,234 @@ void blobReallocMalloc(Blob *pBlob, unsigned int newSize){
 /*
 ** Attempt to resize a blob so that its internal buffer is
 ** nByte in size.  The blob is truncated if necessary.
+**
+** libfsl: return 0, or 1 with the blob unchanged if a memory budget
+** refuses the growth.
 */
-void blob_resize(Blob *pBlob, unsigned int newSize){
-  pBlob->xRealloc(pBlob, newSize+1);
+int blob_resize(Blob *pBlob, blob_size_t newSize){
+  if( blobRealloc(pBlob, newSize+1) ) return 1;
   pBlob->nUsed = newSize;
   pBlob->aData[newSize] = 0;
+  return 0;
+}
+
+/*
+** Make sure the buffer of a blob can hold at least n bytes of content,
+** plus the nul terminator, without being reallocated.  The content of
+** the blob is unchanged.  Return 0, or 1 if a memory budget refuses the
+** growth.
+*/
+int blob_reserve(Blob *pBlob, blob_size_t n){
+  if( (sqlite3_int64)n + 1 > pBlob->nAlloc ){
+    blob_assert_safe_size((i64)n + 1);
+    return blobRealloc(pBlob, n+1);
+  }
+  return 0;
+}
+
+/*
+** FIFO access.  The unread content of a blob is the bytes between
+** iCursor and nUsed.  A producer appends to the end while a consumer
+** reads from iCursor with blob_peek() and blob_consume().  Consumed
+** space is reclaimed lazily, see blob_consume().
+*/
+
+/*
+** True if the buffer of a blob is not its own to write: static text, a
+** shared slice or a file mapping.
+*/
+#define blobIsView(X) ((X)->xRealloc==blobReallocStatic \
+                       || (X)->xRealloc==blobReallocShared \
+                       || (X)->xRealloc==blobReallocMmap)
+
+/*
+** Move the unread content of a blob to the start of its buffer.  A blob
+** that does not own its buffer is compacted by advancing aData instead.
+*/
+void blob_compact(Blob *pBlob){
+  blob_size_t n = pBlob->iCursor;
+  if( n==0 ) return;
+  if( pBlob->xRealloc==blobReallocMmap ){
+    blobMmapAdvance(pBlob, n);
+  }else if( blobIsView(pBlob) ){
+    pBlob->aData += n;
+    pBlob->nAlloc -= n;
+  }else{
+    memmove(pBlob->aData, pBlob->aData + n, pBlob->nUsed - n);
+    pBlob->aData[pBlob->nUsed - n] = 0;
+  }
+  pBlob->nUsed -= n;
+  pBlob->iCursor = 0;
+}
+
+/*
+** Return a pointer to the next n unread bytes of a blob without
+** consuming them, or NULL if fewer than n bytes are unread.  The
+** pointer is valid until the blob is next changed or consumed from.
+*/
+char *blob_peek(Blob *pBlob, blob_size_t n){
+  if( blob_unread(pBlob)<n ) return 0;
+  return pBlob->aData + pBlob->iCursor;
+}
+
+/*
+** Consume up to n unread bytes from the front of a blob, copying them
+** into aOut unless aOut is NULL.  Return the number of bytes consumed.
+**
+** Once everything has been read the blob is emptied in place.  Otherwise
+** the buffer is compacted when the consumed prefix reaches the size of
+** the unread remainder, so each byte is moved at most once on average.
+*/
+blob_size_t blob_consume(Blob *pBlob, char *aOut, blob_size_t n){
+  blob_size_t nUnread = blob_unread(pBlob);
+  if( n>nUnread ) n = nUnread;
+  if( aOut ) memcpy(aOut, pBlob->aData + pBlob->iCursor, n);
+  pBlob->iCursor += n;
+  if( pBlob->iCursor==pBlob->nUsed ){
+    if( blobIsView(pBlob) ){
+      blob_compact(pBlob);
+    }else{
+      pBlob->nUsed = pBlob->iCursor = 0;
+      if( pBlob->nAlloc ) pBlob->aData[0] = 0;
+    }
+  }else if( pBlob->iCursor>=BLOB_COMPACT_MIN
+         && pBlob->iCursor>=pBlob->nUsed - pBlob->iCursor ){
+    blob_compact(pBlob);
+  }
+  return n;
+}
+
+/*
+** Turn a blob into a fixed-capacity FIFO of nCap bytes.  Any prior
+** content of the blob is discarded, not freed.  Feed it with
+** blob_fifo_write(), which never grows the buffer.
+*/
+void blob_fifo_init(Blob *pBlob, blob_size_t nCap){
+  *pBlob = empty_blob;
+  blob_reserve(pBlob, nCap);
+}
+
+/*
+** Append up to n bytes of aData to a FIFO created by blob_fifo_init(),
+** compacting it if that makes room.  Return the number of bytes
+** accepted, which is less than n if the FIFO is full.
+*/
+blob_size_t blob_fifo_write(Blob *pBlob, const char *aData, blob_size_t n){
+  blob_size_t nFree;
+  if( pBlob->nAlloc - pBlob->nUsed < n+1 && pBlob->iCursor>0 ){
+    blob_compact(pBlob);
+  }
+  nFree = pBlob->nAlloc>pBlob->nUsed ? pBlob->nAlloc - 1 - pBlob->nUsed : 0;
+  if( n>nFree ) n = nFree;
+  if( n==0 ) return 0;
+  memcpy(pBlob->aData + pBlob->nUsed, aData, n);
+  pBlob->nUsed += n;
+  pBlob->aData[pBlob->nUsed] = 0;
+  return n;
+}
+
+/*
+** Extract N bytes from blob pFrom and use it to initialize blob pTo.
+** Return the actual number of bytes extracted.  The cursor position
+** is advanced by the number of bytes extracted.
+**
+** After this call completes, pTo will be an ephemeral blob.
+*/
+blob_size_t blob_extract(Blob *pFrom, blob_size_t N, Blob *pTo){
+  blob_is_init(pFrom);
+  assert_blob_is_reset(pTo);
+  if( N>blob_unread(pFrom) ){
+    N = blob_unread(pFrom);
+    if( N==0 ){
+      blob_zero(pTo);
+      return 0;
+    }
+  }
+  pTo->nUsed = N;
+  pTo->nAlloc = N;
+  pTo->aData = &pFrom->aData[pFrom->iCursor];
+  pTo->iCursor = 0;
+  pTo->blobFlags = 0;
+  pTo->xRealloc = blobReallocStatic;
+  pFrom->iCursor += N;
+  return N;
+}
+
+/*
+** Extract a single line of text from pFrom beginning at the current
+** cursor location and use that line of text to initialize pTo.
+** pTo will include the terminating \n.  Return the number of bytes
+** in the line including the \n at the end.  0 is returned at
+** end-of-file.
+**
+** The cursor of pFrom is left pointing at the first byte past the
+** \n that terminated the line.
+**
+** pTo will be an ephermeral blob.  If pFrom changes, it might alter
+** pTo as well.
+*/
+blob_size_t blob_line(Blob *pFrom, Blob *pTo){
+  blob_size_t n = blob_unread(pFrom);
+  blob_size_t i = scan_newline(pFrom->aData + pFrom->iCursor, n);
+  if( i<n ) i++;
+  return blob_extract(pFrom, i, pTo);
+}
+
+/*
+** Split the unread content of pFrom into lines with blob_line(), filling
+** aLine[0..nLine-1].  Return the number of lines extracted, which is
+** less than nLine only if the end of pFrom was reached.  Call again to
+** continue from where the previous call stopped.
+*/
+int blob_split_lines(Blob *pFrom, Blob *aLine, int nLine){
+  int i;
+  for(i=0; i<nLine; i++){
+    aLine[i] = empty_blob;
+    if( blob_line(pFrom, &aLine[i])==0 ) break;
+  }
+  return i;
+}
+
+/*
+** Trim whitespace off of the end of a blob.  Return the number
+** of characters remaining.
+**
+** All this does is reduce the length counter.  This routine does
+** not insert a new zero terminator.
+*/
+blob_size_t blob_trim(Blob *p){
+  char *z = p->aData;
+  blob_size_t n = p->nUsed;
+  while( n>0 && fossil_isspace(z[n-1]) ){ n--; }
+  p->nUsed = n;
+  return n;
+}
+
+/*
+** Extract a single token from pFrom and use it to initialize pTo.
+** Return the number of bytes in the token.  If no token is found,
+** return 0.
+**
+** A token consists of one or more non-space characters.  Leading
+** whitespace is ignored.
+**
+** The cursor of pFrom is left pointing at the first character past
+** the end of the token.
+**
+** pTo will be an ephermeral blob.  If pFrom changes, it might alter
+** pTo as well.
+*/
+blob_size_t blob_token(Blob *pFrom, Blob *pTo){
+  char *aData = pFrom->aData;
+  blob_size_t n = pFrom->nUsed;
+  blob_size_t i = pFrom->iCursor;
+  blob_size_t nToken;
+  i += scan_nonspace(&aData[i], n-i);
+  pFrom->iCursor = i;
+  i += scan_space(&aData[i], n-i);
+  nToken = blob_extract(pFrom, i-pFrom->iCursor, pTo);
+  pFrom->iCursor = i + scan_nonspace(&aData[i], n-i);
+  return nToken;
 }
 
 /*
@@ -229,7 +915,11 @@ void blob_resize(Blob *pBlob, unsigned int newSize){
 ** the number of bytes read into the blob.  Any prior content
 ** of the blob is discarded, not freed.
 */
-int blob_read_from_channel(Blob *pBlob, FILE *in, int nToRead){
+blob_ssize_t blob_read_from_channel(
+  Blob *pBlob,
+  FILE *in,
+  blob_ssize_t nToRead
+){
   size_t n;
   blob_zero(pBlob);
   if( nToRead<0 ){
@@ -241,7 +931,7 @@ int blob_read_from_channel(Blob *pBlob, FILE *in, int nToRead){
       }
     }
   }else{
-    blob_resize(pBlob, nToRead);
+    if( blob_resize(pBlob, nToRead) ) return 0;
     n = fread(blob_buffer(pBlob), 1, nToRead, in);
     blob_resize(pBlob, n);
   }
@@ -285,7 +975,7 @@ void blob_reset(Blob *pBlob){
 ** Initialize a blob to a string or byte-array constant of a specified length.
 ** Any prior data in the blob is discarded.
 */
-void blob_init(Blob *pBlob, const char *zData, int size){
+void blob_init(Blob *pBlob, const char *zData, blob_ssize_t size){
   assert_blob_is_reset(pBlob);
   if( zData==0 ){
     *pBlob = empty_blob;
@@ -299,6 +989,25 @@ void blob_init(Blob *pBlob, const char *zData, int size){
   }
 }
 
+/*
+** Initialize an empty blob that keeps its content in the nSpace bytes
+** of aSpace for as long as it fits.  Short strings built this way never
+** touch the heap.  aSpace must outlive the blob, so such a blob must
+** not be copied out of the scope of its buffer.  Any prior data in the
+** blob is discarded.
+*/
+void blob_init_inline(Blob *pBlob, char *aSpace, blob_size_t nSpace){
+  assert_blob_is_reset(pBlob);
+  assert( nSpace>0 );
+  aSpace[0] = 0;
+  pBlob->nUsed = 0;
+  pBlob->nAlloc = nSpace;
+  pBlob->aData = aSpace;
+  pBlob->iCursor = 0;
+  pBlob->blobFlags = 0;
+  pBlob->xRealloc = blobReallocInline;
+}
+
 /*
 ** Do printf-style string rendering and append the results to a blob.  Or
 ** if pBlob==0, do printf-style string rendering directly to stdout.
@@ -0,0 +1,246 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** A BlobChain is an append-only Blob stored as a list of segments.
+** When the segment being appended to fills up it is linked into the
+** chain and a new one is started, so growing the chain never copies
+** the content accumulated so far.  The segments are joined into a
+** single buffer only if blob_str() or blob_materialize() is called,
+** and blob_chain_write() sends them to a file descriptor as they are.
+**
+** The segment being appended to is an ordinary Blob, BlobChain.tail,
+** whose xRealloc is blobReallocChain().  Pass &BlobChain.tail to
+** blob_append(), vxprintf() and friends.
+*/
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "fslbase.h"
+
+/*
+** Every segment buffer is preceded by this header.
+*/
+struct BlobChainSeg {
+  BlobChainSeg *pNext;           /* Next segment in the chain */
+  blob_size_t nData;             /* Bytes of content in this segment */
+  blob_size_t nAlloc;            /* Size of the buffer, header included */
+  unsigned int blobFlags;        /* Accounting bits of the buffer */
+};
+
+#define chainSegData(S)  ((char*)((S)+1))
+#define chainSegOf(Z)    (((BlobChainSeg*)(Z))-1)
+
+/*
+** The tail of an empty chain.  It is never written.
+*/
+static char zChainEmpty[1];
+
+/*
+** Number of iovec entries handed to a single writev() call.
+*/
+#define CHAIN_IOV  64
+
+/*
+** Allocate a segment that holds at least nData bytes.  The buffer comes
+** from blobReallocMalloc(), so that it is counted against the memory
+** budgets and can come from the buffer cache.  Return NULL, with
+** BLOBFLAG_OverBudget set on the tail of p, if a budget refuses it.
+*/
+static BlobChainSeg *chainSegNew(BlobChain *p, blob_size_t nData){
+  Blob b = empty_blob;
+  BlobChainSeg *pSeg;
+  blobReallocMalloc(&b, sizeof(*pSeg) + nData);
+  if( b.blobFlags & BLOBFLAG_OverBudget ){
+    p->tail.blobFlags |= BLOBFLAG_OverBudget;
+    return 0;
+  }
+  pSeg = (BlobChainSeg*)b.aData;
+  pSeg->pNext = 0;
+  pSeg->nData = 0;
+  pSeg->nAlloc = b.nAlloc;
+  pSeg->blobFlags = b.blobFlags;
+  return pSeg;
+}
+
+/*
+** Free a segment made by chainSegNew()
+*/
+static void chainSegFree(BlobChainSeg *pSeg){
+  Blob b = empty_blob;
+  b.aData = (char*)pSeg;
+  b.nAlloc = pSeg->nAlloc;
+  b.blobFlags = pSeg->blobFlags;
+  blobReallocMalloc(&b, 0);
+}
+
+/*
+** Initialize an empty chain whose segments are szSeg bytes in size,
+** or BLOB_CHAIN_SEGMENT bytes if szSeg is zero.
+*/
+void blob_chain_init(BlobChain *p, unsigned int szSeg){
+  p->tail.nUsed = 0;
+  p->tail.nAlloc = 1;
+  p->tail.iCursor = 0;
+  p->tail.blobFlags = 0;
+  p->tail.aData = zChainEmpty;
+  p->tail.xRealloc = blobReallocChain;
+  p->pFirst = p->pLast = 0;
+  p->nPrior = 0;
+  p->szSeg = szSeg ? szSeg : BLOB_CHAIN_SEGMENT;
+}
+
+/*
+** A reallocation function for the tail of a BlobChain.
+**
+** Growing the tail links the current segment into the chain and starts
+** a new, empty one that can hold at least newSize-nUsed bytes.  The
+** growth policy is not consulted for chains, blob_append() asks for
+** exactly the space it needs.  A newSize of 0 frees every segment and
+** leaves an empty chain behind.
+**
+** Other than through blob_append() and vxprintf(), the tail is only
+** meant to be used through blob_str(), blob_materialize() and
+** blob_reset().
+*/
+void blobReallocChain(Blob *pBlob, blob_size_t newSize){
+  BlobChain *p = (BlobChain*)pBlob;
+  BlobChainSeg *pSeg, *pNew;
+  blob_size_t nNew;
+  if( newSize==0 ){
+    blob_chain_reset(p);
+    return;
+  }
+  if( newSize<=pBlob->nAlloc ){
+    if( pBlob->nUsed>newSize ) pBlob->nUsed = newSize;
+    return;
+  }
+  nNew = newSize - pBlob->nUsed;
+  if( nNew<p->szSeg ) nNew = p->szSeg;
+  pNew = chainSegNew(p, nNew);
+  if( pNew==0 ) return;
+  if( pBlob->aData!=zChainEmpty ){
+    pSeg = chainSegOf(pBlob->aData);
+    if( pBlob->nUsed==0 ){
+      chainSegFree(pSeg);
+    }else{
+      pSeg->nData = pBlob->nUsed;
+      if( p->pLast ){
+        p->pLast->pNext = pSeg;
+      }else{
+        p->pFirst = pSeg;
+      }
+      p->pLast = pSeg;
+      p->nPrior += pBlob->nUsed;
+    }
+  }
+  pBlob->aData = chainSegData(pNew);
+  pBlob->nUsed = 0;
+  pBlob->nAlloc = pNew->nAlloc - sizeof(*pNew);
+}
+
+/*
+** Join all segments of a chain into a single nul-terminated buffer
+** owned by the tail.  This is a no-op if the chain has only its tail.
+** Return 0, or 1 with the chain unchanged if the content is too large
+** for a blob or, with BLOBFLAG_OverBudget set on the tail, if a memory
+** budget refuses the joined buffer.
+*/
+int blob_chain_flatten(BlobChain *p){
+  BlobChainSeg *pSeg, *pNext, *pNew;
+  blob_size_t n;
+  char *z;
+  if( p->pFirst==0 ) return 0;
+  if( blob_chain_size(p)>=(u64)MAX_BLOB_SIZE-1-sizeof(*pNew) ) return 1;
+  n = (blob_size_t)blob_chain_size(p);
+  pNew = chainSegNew(p, n + 1);
+  if( pNew==0 ) return 1;
+  z = chainSegData(pNew);
+  for(pSeg=p->pFirst; pSeg; pSeg=pNext){
+    pNext = pSeg->pNext;
+    memcpy(z, chainSegData(pSeg), pSeg->nData);
+    z += pSeg->nData;
+    chainSegFree(pSeg);
+  }
+  memcpy(z, p->tail.aData, p->tail.nUsed);
+  if( p->tail.aData!=zChainEmpty ){
+    chainSegFree(chainSegOf(p->tail.aData));
+  }
+  p->pFirst = p->pLast = 0;
+  p->nPrior = 0;
+  p->tail.aData = chainSegData(pNew);
+  p->tail.aData[n] = 0;
+  p->tail.nUsed = n;
+  p->tail.nAlloc = pNew->nAlloc - sizeof(*pNew);
+  return 0;
+}
+
+/*
+** Free all segments of a chain and make it empty again.
+*/
+void blob_chain_reset(BlobChain *p){
+  BlobChainSeg *pSeg, *pNext;
+  for(pSeg=p->pFirst; pSeg; pSeg=pNext){
+    pNext = pSeg->pNext;
+    chainSegFree(pSeg);
+  }
+  if( p->tail.aData!=zChainEmpty ){
+    chainSegFree(chainSegOf(p->tail.aData));
+  }
+  blob_chain_init(p, p->szSeg);
+}
+
+/*
+** Append text or data to the end of a chain.
+*/
+void blob_chain_append(BlobChain *p, const char *aData, blob_ssize_t nData){
+  blob_append(&p->tail, aData, nData);
+}
+
+/*
+** Do printf-style string rendering and append the results to a chain.
+*/
+void blob_chain_appendf(BlobChain *p, const char *zFormat, ...){
+  va_list ap;
+  va_start(ap, zFormat);
+  vxprintf(&p->tail, zFormat, ap);
+  va_end(ap);
+}
+
+/*
+** Write the content of a chain to file descriptor fd without joining
+** its segments.  Return the number of bytes written, which may exceed
+** what a single blob holds, or -1 on error.
+*/
+off_t blob_chain_write(BlobChain *p, int fd){
+  struct iovec a[CHAIN_IOV];
+  BlobChainSeg *pSeg = p->pFirst;
+  int n = 0;
+  for(;;){
+    for(; pSeg && n<CHAIN_IOV; pSeg=pSeg->pNext){
+      a[n].iov_base = chainSegData(pSeg);
+      a[n++].iov_len = pSeg->nData;
+    }
+    if( pSeg==0 && n<CHAIN_IOV ){
+      if( p->tail.nUsed>0 ){
+        a[n].iov_base = p->tail.aData;
+        a[n++].iov_len = p->tail.nUsed;
+      }
+      if( file_writev(fd, a, n) ) return -1;
+      break;
+    }
+    if( file_writev(fd, a, n) ) return -1;
+    n = 0;
+  }
+  return blob_chain_size(p);
+}
@@ -0,0 +1,211 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** zlib compression of Blobs in the format Fossil stores content in: a
+** 4-byte big-endian uncompressed size followed by a zlib stream.  The
+** size header lets blob_uncompress() allocate its output exactly once.
+*/
+
+#include <zlib.h>
+
+#include "fslbase.h"
+
+/*
+** Largest expansion a zlib stream can encode, per byte of input.
+*/
+#define ZLIB_MAX_RATIO  1032
+
+/*
+** Minimum output space handed to each deflate() call of a stream.
+*/
+#define DEFLATE_CHUNK   16384
+
+static void compressHeader(unsigned char *z, u64 n){
+  z[0] = n>>24 & 0xff;
+  z[1] = n>>16 & 0xff;
+  z[2] = n>>8 & 0xff;
+  z[3] = n & 0xff;
+}
+
+/*
+** Compress pIn at the given zlib level (0..9, or -1 for the default)
+** and store the result in pOut.  pIn and pOut may be the same blob.
+** Any prior content of pOut is discarded, not freed, unless pOut is pIn.
+** Return 0 on success or 1 if pIn is 4GB or more, which the size
+** header cannot describe, or if a memory budget refuses the output.
+*/
+int blob_compress_level(Blob *pIn, Blob *pOut, int level){
+  u64 nIn = blob_size(pIn);
+  uLongf nOut;
+  Blob temp;
+  unsigned char *outBuf;
+  if( nIn>0xffffffff ) return 1;
+  nOut = compressBound(nIn);
+  temp = empty_blob;
+  if( blob_resize(&temp, (blob_size_t)(nOut+4)) ) return 1;
+  outBuf = (unsigned char*)blob_buffer(&temp);
+  compressHeader(outBuf, nIn);
+  if( compress2(&outBuf[4], &nOut, (unsigned char*)blob_buffer(pIn),
+                nIn, level)!=Z_OK ){
+    blob_reset(&temp);
+    return 1;
+  }
+  if( pOut==pIn ) blob_reset(pOut);
+  assert_blob_is_reset(pOut);
+  *pOut = temp;
+  blob_resize(pOut, (blob_size_t)(nOut+4));
+  return 0;
+}
+
+/*
+** Compress a blob pIn.  Store the result in pOut.  It is ok for pIn and
+** pOut to be the same blob.
+**
+** pOut must either be the same as pIn or else uninitialized.
+*/
+int blob_compress(Blob *pIn, Blob *pOut){
+  return blob_compress_level(pIn, pOut, Z_DEFAULT_COMPRESSION);
+}
+
+/*
+** Uncompress blob pIn and store the result in pOut.  It is ok for pIn and
+** pOut to be the same blob.
+**
+** pOut must be either uninitialized or the same as pIn.
+**
+** Return 0 on success or 1 if pIn is not valid compressed content, its
+** size header claims more than a blob can hold, or a memory budget
+** refuses the output.
+*/
+int blob_uncompress(Blob *pIn, Blob *pOut){
+  unsigned char *inBuf = (unsigned char*)blob_buffer(pIn);
+  u64 nIn = blob_size(pIn);
+  u64 nOut;
+  uLongf nOut2;
+  Blob temp;
+  if( nIn<=4 ) return 1;
+  nOut = ((u64)inBuf[0]<<24) + (inBuf[1]<<16) + (inBuf[2]<<8) + inBuf[3];
+  if( nOut>(nIn-4)*ZLIB_MAX_RATIO || nOut>=(u64)MAX_BLOB_SIZE-1 ) return 1;
+  temp = empty_blob;
+  if( blob_resize(&temp, (blob_size_t)nOut) ) return 1;
+  nOut2 = nOut;
+  if( uncompress((unsigned char*)blob_buffer(&temp), &nOut2,
+                 &inBuf[4], nIn-4)!=Z_OK || nOut2!=nOut ){
+    blob_reset(&temp);
+    return 1;
+  }
+  if( pOut==pIn ) blob_reset(pOut);
+  assert_blob_is_reset(pOut);
+  *pOut = temp;
+  return 0;
+}
+
+/*
+** Run deflate() over the pending input of a stream, growing the output
+** blob as needed, until the input is used up or, when flush is Z_FINISH,
+** the stream is complete.
+*/
+static int deflateStep(BlobDeflate *p, int flush){
+  z_stream *s = (z_stream*)p->pStream;
+  Blob *pOut = p->pOut;
+  blob_size_t nAvail;
+  int rc;
+  do{
+    nAvail = pOut->nAlloc>pOut->nUsed ? pOut->nAlloc - pOut->nUsed - 1 : 0;
+    if( nAvail<DEFLATE_CHUNK ){
+      if( blob_reserve(pOut, pOut->nUsed + pOut->nUsed/2 + DEFLATE_CHUNK) ){
+        return 1;
+      }
+      nAvail = pOut->nAlloc - pOut->nUsed - 1;
+    }
+    s->next_out = (unsigned char*)pOut->aData + pOut->nUsed;
+    s->avail_out = nAvail>0x40000000 ? 0x40000000 : (uInt)nAvail;
+    nAvail = s->avail_out;
+    rc = deflate(s, flush);
+    pOut->nUsed += nAvail - s->avail_out;
+    pOut->aData[pOut->nUsed] = 0;
+    if( rc==Z_STREAM_END ) return 0;
+    if( rc!=Z_OK && rc!=Z_BUF_ERROR ) return 1;
+  }while( s->avail_in>0 || (flush==Z_FINISH) || s->avail_out==0 );
+  return 0;
+}
+
+/*
+** Start compressing into pOut at the given zlib level (0..9, or -1 for
+** the default).  The compressed content, size header included, is
+** appended to whatever pOut already holds.  pOut must not be the tail
+** of a BlobChain.  Return 0 on success or 1 on error.
+*/
+int blob_deflate_init(BlobDeflate *p, Blob *pOut, int level){
+  z_stream *s = fossil_malloc( sizeof(*s) );
+  memset(s, 0, sizeof(*s));
+  if( deflateInit(s, level)!=Z_OK ){
+    fossil_free(s);
+    p->pStream = 0;
+    return 1;
+  }
+  p->pStream = s;
+  p->pOut = pOut;
+  p->nIn = 0;
+  p->iHeader = blob_size(pOut);
+  blob_append(pOut, "\0\0\0\0", 4);
+  if( blob_size(pOut)!=p->iHeader+4 ){
+    /* A memory budget refused the header */
+    deflateEnd(s);
+    fossil_free(s);
+    p->pStream = 0;
+    return 1;
+  }
+  return 0;
+}
+
+/*
+** Feed nData bytes of aData to a stream.  If nData<0 then everything up
+** to the first 0x00 byte is compressed.  Return 0 on success or 1 on
+** error.
+*/
+int blob_deflate_append(BlobDeflate *p, const char *aData, blob_ssize_t nData){
+  z_stream *s = (z_stream*)p->pStream;
+  if( s==0 ) return 1;
+  if( nData<0 ) nData = strlen(aData);
+  p->nIn += nData;
+  while( nData>0 ){
+    uInt n = nData>0x40000000 ? 0x40000000 : (uInt)nData;
+    s->next_in = (unsigned char*)aData;
+    s->avail_in = n;
+    if( deflateStep(p, Z_NO_FLUSH) ) return 1;
+    aData += n;
+    nData -= n;
+  }
+  return 0;
+}
+
+/*
+** Complete a stream and release its resources.  The output blob then
+** holds content blob_uncompress() accepts.  Return 0 on success or 1 if
+** any step failed or more than 4GB were compressed.
+*/
+int blob_deflate_finish(BlobDeflate *p){
+  z_stream *s = (z_stream*)p->pStream;
+  int rc;
+  if( s==0 ) return 1;
+  s->next_in = 0;
+  s->avail_in = 0;
+  rc = deflateStep(p, Z_FINISH);
+  deflateEnd(s);
+  fossil_free(s);
+  p->pStream = 0;
+  if( rc || p->nIn>0xffffffff ) return 1;
+  compressHeader((unsigned char*)p->pOut->aData + p->iHeader, p->nIn);
+  return 0;
+}
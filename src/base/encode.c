@@ -0,0 +1,553 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** Hexadecimal and base64 encoding.  Whole blocks go through SSSE3 or
+** AVX2 kernels when the CPU has them, hexadecimal decoding through SSE2,
+** and the remaining bytes through the portable code.
+*/
+
+#include "fslbase.h"
+#include "simd.h"
+
+static const char zHex[] = "0123456789abcdef";
+static const char zBase64[] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*
+** Value of each 7-bit character as a base64 digit, or -1
+*/
+static const signed char aBase64[] = {
+  -1, -1, -1, -1, -1, -1, -1, -1,   -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1,   -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1,   -1, -1, -1, 62, -1, -1, -1, 63,
+  52, 53, 54, 55, 56, 57, 58, 59,   60, 61, -1, -1, -1, -1, -1, -1,
+  -1,  0,  1,  2,  3,  4,  5,  6,    7,  8,  9, 10, 11, 12, 13, 14,
+  15, 16, 17, 18, 19, 20, 21, 22,   23, 24, 25, -1, -1, -1, -1, -1,
+  -1, 26, 27, 28, 29, 30, 31, 32,   33, 34, 35, 36, 37, 38, 39, 40,
+  41, 42, 43, 44, 45, 46, 47, 48,   49, 50, 51, -1, -1, -1, -1, -1,
+};
+
+/*
+** Value of a hexadecimal digit in either case, or -1
+*/
+static int hexValue(unsigned char c){
+  if( c>='0' && c<='9' ) return c - '0';
+  c |= 0x20;
+  if( c>='a' && c<='f' ) return c - 'a' + 10;
+  return -1;
+}
+
+#ifdef FSL_SSE2
+/*
+** Bytes of x that are no larger than k are set to 0xff, others to 0.
+*/
+#define le8(x,k)  _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(k)), x)
+
+/*
+** Convert 16 hexadecimal digits to their values.  Return false if any
+** of them is not a hexadecimal digit.
+*/
+static int hexValue16(__m128i c, __m128i *pV){
+  __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+  __m128i l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)),
+                           _mm_set1_epi8('a'));
+  __m128i isD = le8(d, 9);
+  __m128i isL = le8(l, 5);
+  *pV = _mm_or_si128(_mm_and_si128(isD, d),
+            _mm_and_si128(isL, _mm_add_epi8(l, _mm_set1_epi8(10))));
+  return _mm_movemask_epi8(_mm_or_si128(isD, isL))==0xffff;
+}
+
+/*
+** Join the digit pairs of 16 hexadecimal digit values into 8 bytes,
+** held in the 16-bit lanes of the result.
+*/
+static __m128i hexJoin16(__m128i v){
+  return _mm_or_si128(
+     _mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00ff)), 4),
+     _mm_srli_epi16(v, 8));
+}
+
+static blob_size_t hexDecodeSse2(
+  const unsigned char *z,
+  unsigned char *p,
+  blob_size_t n
+){
+  blob_size_t i;
+  __m128i v0, v1;
+  for(i=0; i+32<=n; i+=32){
+    if( !hexValue16(_mm_loadu_si128((const __m128i*)(z+i)), &v0)
+     || !hexValue16(_mm_loadu_si128((const __m128i*)(z+i+16)), &v1) ){
+      break;
+    }
+    _mm_storeu_si128((__m128i*)(p+i/2),
+                     _mm_packus_epi16(hexJoin16(v0), hexJoin16(v1)));
+  }
+  return i;
+}
+
+/*
+** Convert 16 base64 digits to their values.  Return false if any of
+** them is not a base64 digit.
+*/
+static int b64Value16(__m128i c, __m128i *pV){
+  __m128i isU = le8(_mm_sub_epi8(c, _mm_set1_epi8('A')), 25);
+  __m128i isL = le8(_mm_sub_epi8(c, _mm_set1_epi8('a')), 25);
+  __m128i isD = le8(_mm_sub_epi8(c, _mm_set1_epi8('0')), 9);
+  __m128i isP = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+  __m128i isS = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+  __m128i off;
+  off = _mm_or_si128(
+      _mm_or_si128(_mm_and_si128(isU, _mm_set1_epi8(-'A')),
+                   _mm_and_si128(isL, _mm_set1_epi8(26-'a'))),
+      _mm_or_si128(_mm_and_si128(isD, _mm_set1_epi8(52-'0')),
+          _mm_or_si128(_mm_and_si128(isP, _mm_set1_epi8(62-'+')),
+                       _mm_and_si128(isS, _mm_set1_epi8(63-'/')))));
+  *pV = _mm_add_epi8(c, off);
+  return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(isU, isL),
+                _mm_or_si128(isD, _mm_or_si128(isP, isS))))==0xffff;
+}
+#endif /* FSL_SSE2 */
+
+#ifdef FSL_SSSE3
+FSL_TARGET_SSSE3
+static blob_size_t hexEncodeSsse3(
+  const unsigned char *p,
+  unsigned char *z,
+  blob_size_t n
+){
+  const __m128i lut = _mm_loadu_si128((const __m128i*)zHex);
+  const __m128i m = _mm_set1_epi8(0x0f);
+  blob_size_t i;
+  __m128i v, hi, lo;
+  for(i=0; i+16<=n; i+=16){
+    v = _mm_loadu_si128((const __m128i*)(p+i));
+    hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), m));
+    lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, m));
+    _mm_storeu_si128((__m128i*)(z+2*i), _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i*)(z+2*i+16), _mm_unpackhi_epi8(hi, lo));
+  }
+  return i;
+}
+
+/*
+** Spread 12 bytes over 16 lanes of 6 bits and map each lane to its
+** base64 digit.  See Wojciech Mula, "Base64 encoding with SIMD
+** instructions".
+*/
+FSL_TARGET_SSSE3
+static blob_size_t b64EncodeSsse3(
+  const unsigned char *p,
+  unsigned char *z,
+  blob_size_t n
+){
+  const __m128i shuf = _mm_setr_epi8(1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10);
+  const __m128i lut = _mm_setr_epi8('a'-26, '0'-52, '0'-52, '0'-52, '0'-52,
+      '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '+'-62, '/'-63, 'A',
+      0, 0);
+  blob_size_t i, j;
+  __m128i v, t0, t1, idx, r;
+  for(i=j=0; i+16<=n; i+=12, j+=16){
+    v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p+i)), shuf);
+    t0 = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)),
+                         _mm_set1_epi32(0x04000040));
+    t1 = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)),
+                         _mm_set1_epi32(0x01000010));
+    idx = _mm_or_si128(t0, t1);
+    r = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    r = _mm_or_si128(r, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), idx),
+                                      _mm_set1_epi8(13)));
+    r = _mm_add_epi8(_mm_shuffle_epi8(lut, r), idx);
+    _mm_storeu_si128((__m128i*)(z+j), r);
+  }
+  return i;
+}
+
+FSL_TARGET_SSSE3
+static blob_size_t b64DecodeSsse3(
+  const unsigned char *z,
+  unsigned char *p,
+  blob_size_t n
+){
+  const __m128i shuf = _mm_setr_epi8(2,1,0, 6,5,4, 10,9,8, 14,13,12,
+                                     -1,-1,-1,-1);
+  unsigned char a[16];
+  blob_size_t i, j;
+  __m128i v;
+  for(i=j=0; i+16<=n; i+=16, j+=12){
+    if( !b64Value16(_mm_loadu_si128((const __m128i*)(z+i)), &v) ) break;
+    v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+    _mm_storeu_si128((__m128i*)a, _mm_shuffle_epi8(v, shuf));
+    memcpy(p+j, a, 12);
+  }
+  return i;
+}
+#endif /* FSL_SSSE3 */
+
+#ifdef FSL_AVX2
+#define le8x32(x,k) _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(k)),x)
+
+FSL_TARGET_AVX2
+static blob_size_t hexEncodeAvx2(
+  const unsigned char *p,
+  unsigned char *z,
+  blob_size_t n
+){
+  const __m256i lut = _mm256_broadcastsi128_si256(
+                          _mm_loadu_si128((const __m128i*)zHex));
+  const __m256i m = _mm256_set1_epi8(0x0f);
+  blob_size_t i;
+  __m256i v, hi, lo, a, b;
+  for(i=0; i+32<=n; i+=32){
+    v = _mm256_loadu_si256((const __m256i*)(p+i));
+    hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v,4), m));
+    lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, m));
+    a = _mm256_unpacklo_epi8(hi, lo);
+    b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256((__m256i*)(z+2*i), _mm256_permute2x128_si256(a,b,0x20));
+    _mm256_storeu_si256((__m256i*)(z+2*i+32), _mm256_permute2x128_si256(a,b,0x31));
+  }
+  return i;
+}
+
+FSL_TARGET_AVX2
+static int hexValue32(__m256i c, __m256i *pV){
+  __m256i d = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+  __m256i l = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)),
+                              _mm256_set1_epi8('a'));
+  __m256i isD = le8x32(d, 9);
+  __m256i isL = le8x32(l, 5);
+  *pV = _mm256_or_si256(_mm256_and_si256(isD, d),
+            _mm256_and_si256(isL, _mm256_add_epi8(l, _mm256_set1_epi8(10))));
+  return _mm256_movemask_epi8(_mm256_or_si256(isD, isL))==-1;
+}
+
+FSL_TARGET_AVX2
+static __m256i hexJoin32(__m256i v){
+  return _mm256_or_si256(
+     _mm256_slli_epi16(_mm256_and_si256(v, _mm256_set1_epi16(0x00ff)), 4),
+     _mm256_srli_epi16(v, 8));
+}
+
+FSL_TARGET_AVX2
+static blob_size_t hexDecodeAvx2(
+  const unsigned char *z,
+  unsigned char *p,
+  blob_size_t n
+){
+  blob_size_t i;
+  __m256i v0, v1;
+  for(i=0; i+64<=n; i+=64){
+    if( !hexValue32(_mm256_loadu_si256((const __m256i*)(z+i)), &v0)
+     || !hexValue32(_mm256_loadu_si256((const __m256i*)(z+i+32)), &v1) ){
+      break;
+    }
+    v0 = _mm256_packus_epi16(hexJoin32(v0), hexJoin32(v1));
+    _mm256_storeu_si256((__m256i*)(p+i/2), _mm256_permute4x64_epi64(v0, 0xd8));
+  }
+  return i;
+}
+
+FSL_TARGET_AVX2
+static blob_size_t b64EncodeAvx2(
+  const unsigned char *p,
+  unsigned char *z,
+  blob_size_t n
+){
+  const __m256i shuf = _mm256_broadcastsi128_si256(
+      _mm_setr_epi8(1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10));
+  const __m256i lut = _mm256_broadcastsi128_si256(
+      _mm_setr_epi8('a'-26, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+        '0'-52, '0'-52, '0'-52, '0'-52, '+'-62, '/'-63, 'A', 0, 0));
+  blob_size_t i, j;
+  __m256i v, t0, t1, idx, r;
+  for(i=j=0; i+28<=n; i+=24, j+=32){
+    v = _mm256_inserti128_si256(
+          _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(p+i))),
+          _mm_loadu_si128((const __m128i*)(p+i+12)), 1);
+    v = _mm256_shuffle_epi8(v, shuf);
+    t0 = _mm256_mulhi_epu16(_mm256_and_si256(v,_mm256_set1_epi32(0x0fc0fc00)),
+                            _mm256_set1_epi32(0x04000040));
+    t1 = _mm256_mullo_epi16(_mm256_and_si256(v,_mm256_set1_epi32(0x003f03f0)),
+                            _mm256_set1_epi32(0x01000010));
+    idx = _mm256_or_si256(t0, t1);
+    r = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+    r = _mm256_or_si256(r, _mm256_and_si256(
+            _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx), _mm256_set1_epi8(13)));
+    r = _mm256_add_epi8(_mm256_shuffle_epi8(lut, r), idx);
+    _mm256_storeu_si256((__m256i*)(z+j), r);
+  }
+  return i;
+}
+
+FSL_TARGET_AVX2
+static int b64Value32(__m256i c, __m256i *pV){
+  __m256i isU = le8x32(_mm256_sub_epi8(c, _mm256_set1_epi8('A')), 25);
+  __m256i isL = le8x32(_mm256_sub_epi8(c, _mm256_set1_epi8('a')), 25);
+  __m256i isD = le8x32(_mm256_sub_epi8(c, _mm256_set1_epi8('0')), 9);
+  __m256i isP = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('+'));
+  __m256i isS = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('/'));
+  __m256i off;
+  off = _mm256_or_si256(
+      _mm256_or_si256(_mm256_and_si256(isU, _mm256_set1_epi8(-'A')),
+                      _mm256_and_si256(isL, _mm256_set1_epi8(26-'a'))),
+      _mm256_or_si256(_mm256_and_si256(isD, _mm256_set1_epi8(52-'0')),
+          _mm256_or_si256(_mm256_and_si256(isP, _mm256_set1_epi8(62-'+')),
+                          _mm256_and_si256(isS, _mm256_set1_epi8(63-'/')))));
+  *pV = _mm256_add_epi8(c, off);
+  return _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(isU, isL),
+                _mm256_or_si256(isD, _mm256_or_si256(isP, isS))))==-1;
+}
+
+FSL_TARGET_AVX2
+static blob_size_t b64DecodeAvx2(
+  const unsigned char *z,
+  unsigned char *p,
+  blob_size_t n
+){
+  const __m256i shuf = _mm256_broadcastsi128_si256(
+      _mm_setr_epi8(2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1));
+  unsigned char a[32];
+  blob_size_t i, j;
+  __m256i v;
+  for(i=j=0; i+32<=n; i+=32, j+=24){
+    if( !b64Value32(_mm256_loadu_si256((const __m256i*)(z+i)), &v) ) break;
+    v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+    v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+    _mm256_storeu_si256((__m256i*)a, _mm256_shuffle_epi8(v, shuf));
+    memcpy(p+j, a, 12);
+    memcpy(p+j+12, a+16, 12);
+  }
+  return i;
+}
+#endif /* FSL_AVX2 */
+
+/*
+** Each of the following runs the best available kernel over the leading
+** whole blocks of its input and returns the number of input bytes
+** consumed.  The caller finishes the rest.
+*/
+static blob_size_t hexEncodeFast(
+  const unsigned char *p,
+  unsigned char *z,
+  blob_size_t n
+){
+  blob_size_t i = 0;
+#ifdef FSL_AVX2
+  if( n>=32 && fsl_cpu_avx2() ) i = hexEncodeAvx2(p, z, n);
+#endif
+#ifdef FSL_SSSE3
+  if( n-i>=16 && fsl_cpu_ssse3() ) i += hexEncodeSsse3(p+i, z+2*i, n-i);
+#endif
+  return i;
+}
+
+static blob_size_t hexDecodeFast(
+  const unsigned char *z,
+  unsigned char *p,
+  blob_size_t n
+){
+  blob_size_t i = 0;
+#ifdef FSL_AVX2
+  if( n>=64 && fsl_cpu_avx2() ) i = hexDecodeAvx2(z, p, n);
+#endif
+#ifdef FSL_SSE2
+  if( n-i>=32 ) i += hexDecodeSse2(z+i, p+i/2, n-i);
+#endif
+  return i;
+}
+
+static blob_size_t b64EncodeFast(
+  const unsigned char *p,
+  unsigned char *z,
+  blob_size_t n
+){
+  blob_size_t i = 0;
+#ifdef FSL_AVX2
+  if( n>=28 && fsl_cpu_avx2() ) i = b64EncodeAvx2(p, z, n);
+#endif
+#ifdef FSL_SSSE3
+  if( n-i>=16 && fsl_cpu_ssse3() ) i += b64EncodeSsse3(p+i, z+i/3*4, n-i);
+#endif
+  return i;
+}
+
+static blob_size_t b64DecodeFast(
+  const unsigned char *z,
+  unsigned char *p,
+  blob_size_t n
+){
+  blob_size_t i = 0;
+#ifdef FSL_AVX2
+  if( n>=32 && fsl_cpu_avx2() ) i = b64DecodeAvx2(z, p, n);
+#endif
+#ifdef FSL_SSSE3
+  if( n-i>=16 && fsl_cpu_ssse3() ) i += b64DecodeSsse3(z+i, p+i/4*3, n-i);
+#endif
+  return i;
+}
+
+/*
+** Encode a N-digit binary hash into a 2N-digit lowercase hexadecimal
+** string, followed by a nul terminator.
+*/
+void encode16(const unsigned char *pIn, unsigned char *zOut, blob_size_t N){
+  blob_size_t i;
+  for(i=hexEncodeFast(pIn, zOut, N); i<N; i++){
+    zOut[2*i] = zHex[pIn[i]>>4];
+    zOut[2*i+1] = zHex[pIn[i]&0xf];
+  }
+  zOut[2*N] = 0;
+}
+
+/*
+** Decode a N-character hexadecimal string, in either case, into N/2
+** bytes of pOut.  Return 0 on success or 1 if N is odd or zIn holds
+** anything but hexadecimal digits.
+*/
+int decode16(const unsigned char *zIn, unsigned char *pOut, blob_size_t N){
+  blob_size_t i;
+  int v1, v2;
+  if( N&1 ) return 1;
+  for(i=hexDecodeFast(zIn, pOut, N); i<N; i+=2){
+    v1 = hexValue(zIn[i]);
+    v2 = hexValue(zIn[i+1]);
+    if( v1<0 || v2<0 ) return 1;
+    pOut[i/2] = (v1<<4) + v2;
+  }
+  return 0;
+}
+
+/*
+** Append the hexadecimal encoding of nData bytes of aData to a blob.
+** If nData<0 then everything up to the first 0x00 byte is encoded.
+*/
+void blob_encode16(Blob *pBlob, const char *aData, blob_ssize_t nData){
+  char *z;
+  if( nData<0 ) nData = strlen(aData);
+  z = blob_append_space(pBlob, 2*(blob_size_t)nData);
+  if( z==0 ) return;
+  encode16((const unsigned char*)aData, (unsigned char*)z, nData);
+}
+
+/*
+** Append the bytes encoded by the n hexadecimal digits of zHex16 to a
+** blob.  If n<0 then the digits end at the first 0x00 byte.  Return 0
+** on success or 1, leaving the blob unchanged, on invalid input or if a
+** memory budget refuses the growth.
+*/
+int blob_decode16(Blob *pBlob, const char *zHex16, blob_ssize_t n){
+  char *z;
+  if( n<0 ) n = strlen(zHex16);
+  if( n&1 ) return 1;
+  z = blob_append_space(pBlob, n/2);
+  if( z==0 ) return 1;
+  if( decode16((const unsigned char*)zHex16, (unsigned char*)z, n) ){
+    pBlob->nUsed = z - pBlob->aData;
+    *z = 0;
+    return 1;
+  }
+  return 0;
+}
+
+/*
+** Append the base64 encoding of nData bytes of aData to a blob, padded
+** with '=' and without line breaks.  If nData<0 then everything up to
+** the first 0x00 byte is encoded.
+*/
+void blob_encode64(Blob *pBlob, const char *aData, blob_ssize_t nData){
+  const unsigned char *p = (const unsigned char*)aData;
+  unsigned char *z;
+  blob_size_t i;
+  if( nData<0 ) nData = strlen(aData);
+  z = (unsigned char*)blob_append_space(pBlob, (nData+2)/3*4);
+  if( z==0 ) return;
+  i = b64EncodeFast(p, z, nData);
+  z += i/3*4;
+  for(; i+2<(blob_size_t)nData; i+=3){
+    *(z++) = zBase64[p[i]>>2];
+    *(z++) = zBase64[((p[i]&0x03)<<4) | (p[i+1]>>4)];
+    *(z++) = zBase64[((p[i+1]&0x0f)<<2) | (p[i+2]>>6)];
+    *(z++) = zBase64[p[i+2]&0x3f];
+  }
+  if( i<(blob_size_t)nData ){
+    *(z++) = zBase64[p[i]>>2];
+    if( i+1<(blob_size_t)nData ){
+      *(z++) = zBase64[((p[i]&0x03)<<4) | (p[i+1]>>4)];
+      *(z++) = zBase64[(p[i+1]&0x0f)<<2];
+    }else{
+      *(z++) = zBase64[(p[i]&0x03)<<4];
+      *(z++) = '=';
+    }
+    *(z++) = '=';
+  }
+}
+
+/*
+** Append the bytes encoded by the n base64 characters of z64 to a blob.
+** If n<0 then the input ends at the first 0x00 byte.  Whitespace is
+** ignored and the trailing '=' padding is optional.  Return 0 on
+** success or 1, leaving the blob unchanged, on invalid input or if a
+** memory budget refuses the growth.
+*/
+int blob_decode64(Blob *pBlob, const char *z64, blob_ssize_t n){
+  const unsigned char *z = (const unsigned char*)z64;
+  blob_size_t i = 0, j = 0, k;
+  unsigned char *p;
+  unsigned int acc = 0;
+  int nq = 0, v, c;
+  if( n<0 ) n = strlen(z64);
+  p = (unsigned char*)blob_append_space(pBlob, n/4*3 + 2);
+  if( p==0 ) return 1;
+  while( i<(blob_size_t)n ){
+    if( nq==0 ){
+      k = b64DecodeFast(&z[i], &p[j], n-i);
+      i += k;
+      j += k/4*3;
+      if( i>=(blob_size_t)n ) break;
+    }
+    c = z[i++];
+    v = c<0x80 ? aBase64[c] : -1;
+    if( v>=0 ){
+      acc = (acc<<6) | v;
+      if( ++nq==4 ){
+        p[j++] = acc>>16;
+        p[j++] = acc>>8;
+        p[j++] = acc;
+        acc = 0;
+        nq = 0;
+      }
+    }else if( c=='=' ){
+      break;
+    }else if( !fossil_isspace(c) ){
+      goto decode_error;
+    }
+  }
+  for(; i<(blob_size_t)n; i++){
+    if( z[i]!='=' && !fossil_isspace(z[i]) ) goto decode_error;
+  }
+  switch( nq ){
+    case 1:  goto decode_error;
+    case 2:  p[j++] = acc>>4;  break;
+    case 3:  p[j++] = acc>>10;  p[j++] = acc>>2;  break;
+  }
+  pBlob->nUsed = (char*)p - pBlob->aData + j;
+  pBlob->aData[pBlob->nUsed] = 0;
+  return 0;
+
+decode_error:
+  pBlob->nUsed = (char*)p - pBlob->aData;
+  *p = 0;
+  return 1;
+}
@@ -0,0 +1,422 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** Moving Blobs to and from file descriptors without going through
+** stdio.
+*/
+
+#define _GNU_SOURCE     /* copy_file_range() on glibc */
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "fslbase.h"
+
+/*
+** Number of iovec entries handed to a single writev() call.
+*/
+#define FILE_IOV  64
+
+/*
+** Write the complete iovec array a[0..n-1] to fd.  Partial writes are
+** resumed where they stopped, interrupted calls are restarted, and a
+** non-blocking descriptor is waited on until it is writable again.
+** The array is modified.  Return 0 on success or -1 on error with
+** errno set.
+*/
+int file_writev(int fd, struct iovec *a, int n){
+  ssize_t r;
+  while( n>0 ){
+    r = writev(fd, a, n);
+    if( r<0 ){
+      if( errno==EINTR ) continue;
+      if( errno==EAGAIN || errno==EWOULDBLOCK ){
+        struct pollfd p;
+        p.fd = fd;
+        p.events = POLLOUT;
+        if( poll(&p, 1, -1)<0 && errno!=EINTR ) return -1;
+        continue;
+      }
+      return -1;
+    }
+    while( n>0 && (size_t)r>=a->iov_len ){
+      r -= a->iov_len;
+      a++;
+      n--;
+    }
+    if( n>0 ){
+      a->iov_base = (char*)a->iov_base + r;
+      a->iov_len -= r;
+    }
+  }
+  return 0;
+}
+
+/*
+** Write the content of n blobs to fd, in order, with as few system
+** calls as possible.  Data goes out straight from each aData, including
+** memory-mapped blobs.  Return the number of bytes written, which may
+** exceed what one blob holds, or -1 on error.
+*/
+off_t blob_writev(int fd, Blob **ap, int n){
+  struct iovec a[FILE_IOV];
+  off_t nTotal = 0;
+  int i, j;
+  for(i=0; i<n; i+=j){
+    for(j=0; j<FILE_IOV && i+j<n; j++){
+      a[j].iov_base = blob_buffer(ap[i+j]);
+      a[j].iov_len = blob_size(ap[i+j]);
+      nTotal += blob_size(ap[i+j]);
+    }
+    if( file_writev(fd, a, j) ) return -1;
+  }
+  return nTotal;
+}
+
+/*
+** Write the content of a blob to fd.  Return the number of bytes
+** written, or -1 on error.
+*/
+blob_ssize_t blob_write_to_fd(Blob *pBlob, int fd){
+  return (blob_ssize_t)blob_writev(fd, &pBlob, 1);
+}
+
+/*
+** Initial buffer size, and least growth, for files whose size is not
+** known in advance.
+*/
+#define FILE_CHUNK  65536
+
+/*
+** copy_file_range() is in FreeBSD 13 and in Linux.
+*/
+#if (defined(__FreeBSD__) && __FreeBSD_version>=1300037) \
+    || (defined(__linux__) && defined(_GNU_SOURCE))
+# define FILE_COPY_RANGE 1
+#endif
+
+/*
+** Read the content of file zFilename into pBlob, which must be reset.
+** A regular file is sized with fstat() and read with as few pread()
+** calls as it takes; anything else, such as a pipe or a FIFO, is read
+** with read() into a buffer grown geometrically until end of file.
+** Return 0 on success.  On error pBlob is left reset and the errno value
+** is returned, EFBIG for content that does not fit in a blob and ENOMEM
+** if a memory budget refuses the space.
+*/
+static int fileRead(const char *zFilename, Blob *pBlob){
+  struct stat st;
+  blob_size_t n = 0, nEnd;
+  u64 nWant;
+  ssize_t r;
+  int fd, bSized, rc = 0;
+  fd = open(zFilename, O_RDONLY|O_CLOEXEC);
+  if( fd<0 ) return errno;
+  if( fstat(fd, &st) ){
+    rc = errno;
+    close(fd);
+    return rc;
+  }
+  bSized = S_ISREG(st.st_mode) && st.st_size>0;
+  /* The blob holds the content and a nul terminator */
+  if( bSized && (u64)st.st_size>=(u64)MAX_BLOB_SIZE-1 ){
+    close(fd);
+    return EFBIG;
+  }
+  blob_zero(pBlob);
+  if( blob_reserve(pBlob, bSized ? (blob_size_t)st.st_size : FILE_CHUNK) ){
+    close(fd);
+    return ENOMEM;
+  }
+  for(;;){
+    nEnd = bSized ? (blob_size_t)st.st_size : pBlob->nAlloc - 1;
+    if( n==nEnd ){
+      if( bSized ) break;
+      nWant = (u64)n + n/2 + FILE_CHUNK;
+      if( nWant>=(u64)MAX_BLOB_SIZE-1 ) nWant = (u64)MAX_BLOB_SIZE-2;
+      if( nWant<=n ){
+        rc = EFBIG;
+        break;
+      }
+      if( blob_reserve(pBlob, (blob_size_t)nWant) ){
+        rc = ENOMEM;
+        break;
+      }
+      nEnd = pBlob->nAlloc - 1;
+    }
+    if( bSized ){
+      r = pread(fd, pBlob->aData+n, nEnd-n, n);
+    }else{
+      r = read(fd, pBlob->aData+n, nEnd-n);
+    }
+    if( r<0 ){
+      if( errno==EINTR ) continue;
+      rc = errno;
+      break;
+    }
+    if( r==0 ) break;
+    n += r;
+    /* blob_reserve() keeps only the bytes counted in nUsed */
+    pBlob->nUsed = n;
+  }
+  close(fd);
+  if( rc ){
+    blob_reset(pBlob);
+  }else{
+    blob_resize(pBlob, n);
+  }
+  return rc;
+}
+
+/*
+** Read the content of file zFilename into pBlob, which must be reset.
+** The blob is sized from fstat() before a single read for regular
+** files.  Return the number of bytes read, or -1 with errno set and the
+** blob left empty.
+*/
+blob_ssize_t blob_read_from_file(Blob *pBlob, const char *zFilename){
+  int rc = fileRead(zFilename, pBlob);
+  if( rc ){
+    blob_zero(pBlob);
+    errno = rc;
+    return -1;
+  }
+  return blob_size(pBlob);
+}
+
+/*
+** Open a new temporary file next to zFilename, with the permissions of
+** zFilename if it exists or else those a newly created file gets.
+** Store its name, from mprintf(), in *pzTmp.  Return the descriptor, or
+** -1 on error.
+*/
+static int fileOpenTemp(const char *zFilename, char **pzTmp){
+  static unsigned int iSeq = 0;
+  struct stat st;
+  int fd, i, bKeep;
+  bKeep = stat(zFilename, &st)==0 && S_ISREG(st.st_mode);
+  for(i=0; i<100; i++){
+    *pzTmp = mprintf("%s-%d-%u.tmp", zFilename, (int)getpid(),
+                     __atomic_add_fetch(&iSeq, 1, __ATOMIC_RELAXED));
+    fd = open(*pzTmp, O_WRONLY|O_CREAT|O_EXCL|O_CLOEXEC, 0666);
+    if( fd>=0 ){
+      if( bKeep ) fchmod(fd, st.st_mode & 07777);
+      return fd;
+    }
+    fossil_free(*pzTmp);
+    *pzTmp = 0;
+    if( errno!=EEXIST ) break;
+  }
+  return -1;
+}
+
+/*
+** Flush temporary file fd to disk, close it and move it over
+** zFilename, then flush the directory so that the rename survives a
+** crash.  If rc is not 0, or any step fails, the temporary file is
+** removed instead.  zTmp is freed.  Return 0 on success or -1 with errno
+** set.
+*/
+static int fileCommit(int fd, char *zTmp, const char *zFilename, int rc){
+  const char *z;
+  char *zDir;
+  int dfd, e;
+  if( rc==0 && fsync(fd) ) rc = -1;
+  if( close(fd) && rc==0 ) rc = -1;
+  if( rc==0 && rename(zTmp, zFilename) ) rc = -1;
+  if( rc ){
+    e = errno;
+    unlink(zTmp);
+    fossil_free(zTmp);
+    errno = e;
+    return -1;
+  }
+  fossil_free(zTmp);
+  z = strrchr(zFilename, '/');
+  zDir = z==0 ? mprintf(".") : z==zFilename ? mprintf("/") :
+                mprintf("%.*s", (int)(z-zFilename), zFilename);
+  dfd = open(zDir, O_RDONLY|O_CLOEXEC);
+  if( dfd>=0 ){
+    fsync(dfd);
+    close(dfd);
+  }
+  fossil_free(zDir);
+  return 0;
+}
+
+/*
+** Replace file zFilename with the content of pBlob.  The content goes
+** to a temporary file in the same directory which is flushed to disk
+** and renamed over zFilename, so that readers see either the old or
+** the new file, whole, even after a crash.  Return the number of bytes
+** written, or -1 with errno set.
+*/
+blob_ssize_t blob_write_to_file(Blob *pBlob, const char *zFilename){
+  char *zTmp;
+  blob_ssize_t n;
+  int fd = fileOpenTemp(zFilename, &zTmp);
+  if( fd<0 ) return -1;
+  n = blob_write_to_fd(pBlob, fd);
+  if( fileCommit(fd, zTmp, zFilename, n<0) ) return -1;
+  return n;
+}
+
+/*
+** Copy the content of file zFrom to the file descriptor fd, starting
+** at the current offsets of both.  The kernel copies the data with
+** copy_file_range() where it can; otherwise it is read and written
+** through a buffer.  Return the number of bytes copied, or -1.
+*/
+static off_t fileCopyFd(int fdFrom, int fd){
+  off_t nTotal = 0;
+  ssize_t r;
+  char zBuf[FILE_CHUNK];
+  struct iovec a;
+#ifdef FILE_COPY_RANGE
+  for(;;){
+    r = copy_file_range(fdFrom, 0, fd, 0, (size_t)1<<30, 0);
+    if( r<0 ){
+      if( errno==EINTR ) continue;
+      if( nTotal==0 && (errno==EXDEV || errno==EINVAL
+                        || errno==ENOSYS || errno==EOPNOTSUPP) ){
+        break;
+      }
+      return -1;
+    }
+    if( r==0 ) return nTotal;
+    nTotal += r;
+  }
+#endif
+  for(;;){
+    r = read(fdFrom, zBuf, sizeof(zBuf));
+    if( r<0 ){
+      if( errno==EINTR ) continue;
+      return -1;
+    }
+    if( r==0 ) return nTotal;
+    a.iov_base = zBuf;
+    a.iov_len = r;
+    if( file_writev(fd, &a, 1) ) return -1;
+    nTotal += r;
+  }
+}
+
+/*
+** Replace file zTo with a copy of file zFrom, the same way as
+** blob_write_to_file() and without moving the data through a blob.
+** Files of any size are copied.  Return the number of bytes copied, or
+** -1 with errno set.
+*/
+off_t file_copy(const char *zFrom, const char *zTo){
+  char *zTmp;
+  off_t n;
+  int fd, fdFrom;
+  fdFrom = open(zFrom, O_RDONLY|O_CLOEXEC);
+  if( fdFrom<0 ) return -1;
+  fd = fileOpenTemp(zTo, &zTmp);
+  if( fd<0 ){
+    close(fdFrom);
+    return -1;
+  }
+  n = fileCopyFd(fdFrom, fd);
+  close(fdFrom);
+  if( fileCommit(fd, zTmp, zTo, n<0) ) return -1;
+  return n;
+}
+
+/*
+** State shared by the threads of one blob_read_batch() call
+*/
+typedef struct FileBatch FileBatch;
+struct FileBatch {
+  BlobReadReq *a;                /* Files to read */
+  int n;                         /* Number of entries in a[] */
+  int iNext;                     /* Next entry to claim */
+  int nErr;                      /* Number of failed reads */
+  int iCat;                      /* Accounting category of the caller */
+  BlobReadFunc xDone;            /* Completion callback, or NULL */
+  void *pArg;                    /* First argument to xDone */
+  pthread_mutex_t mutex;         /* Serializes calls to xDone */
+};
+
+/*
+** Body of each reader thread: claim the next file until none are left.
+*/
+static void *fileBatchWorker(void *pArg){
+  FileBatch *p = (FileBatch*)pArg;
+  BlobReadReq *pReq;
+  int i;
+  blob_account_category(p->iCat);
+  while( (i = __atomic_fetch_add(&p->iNext, 1, __ATOMIC_RELAXED))<p->n ){
+    pReq = &p->a[i];
+    pReq->rc = fileRead(pReq->zFilename, pReq->pBlob);
+    if( pReq->rc ) __atomic_add_fetch(&p->nErr, 1, __ATOMIC_RELAXED);
+    if( p->xDone ){
+      pthread_mutex_lock(&p->mutex);
+      p->xDone(p->pArg, pReq);
+      pthread_mutex_unlock(&p->mutex);
+    }
+  }
+  return 0;
+}
+
+/*
+** Read the n files a[].zFilename into the blobs a[].pBlob, which must
+** be reset, with up to nDepth reads in flight at once (BLOB_READ_DEPTH
+** if nDepth is 0 or less).  Each read runs on its own thread with
+** open(), fstat() and pread(), so the latency of small files and cold
+** caches overlaps instead of adding up.  The calling thread takes part
+** and the call returns once every file has been read.
+**
+** The outcome of each file is stored in a[].rc: 0, or an errno value
+** with the blob left reset.  If xDone is not NULL it is called with
+** pArg and the entry as each file completes, in no particular order
+** and possibly from another thread, but never twice at once.  Buffers
+** are accounted to the category of the calling thread.
+**
+** Return the number of files that could not be read.
+*/
+int blob_read_batch(BlobReadReq *a, int n, int nDepth, BlobReadFunc xDone,
+                    void *pArg){
+  FileBatch b;
+  pthread_t aThread[BLOB_READ_MAX_DEPTH];
+  int i, nThread = 0;
+  if( nDepth<=0 ) nDepth = BLOB_READ_DEPTH;
+  if( nDepth>BLOB_READ_MAX_DEPTH ) nDepth = BLOB_READ_MAX_DEPTH;
+  if( nDepth>n ) nDepth = n;
+  b.a = a;
+  b.n = n;
+  b.iNext = 0;
+  b.nErr = 0;
+  b.iCat = blob_account_category(0);
+  blob_account_category(b.iCat);
+  b.xDone = xDone;
+  b.pArg = pArg;
+  pthread_mutex_init(&b.mutex, 0);
+  for(i=1; i<nDepth; i++){
+    if( pthread_create(&aThread[nThread], 0, fileBatchWorker, &b) ) break;
+    nThread++;
+  }
+  fileBatchWorker(&b);
+  for(i=0; i<nThread; i++){
+    pthread_join(aThread[i], 0);
+  }
+  pthread_mutex_destroy(&b.mutex);
+  return b.nErr;
+}
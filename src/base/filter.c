@@ -0,0 +1,174 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** An approximate set of byte strings: a blocked Bloom filter.  A test
+** that fails means the string was never added, so the caller can skip
+** the database; a test that passes may be wrong with a small
+** probability.  Each string sets nHash bits inside a single 512-bit
+** block picked by its hash, so that adding or testing a string touches
+** one cache line.  Strings cannot be removed; rebuild the filter
+** instead.
+**
+** A filter can be saved to a blob and loaded back.  The format is a
+** header of little-endian numbers followed by the bits:
+**
+**     magic "FSLBLOOM" | version:u32 | nHash:u32 | nBlock:u64 |
+**     nItem:u64 | nBlock*64 bytes of bits
+*/
+
+#include "fslbase.h"
+
+#define FILTER_WORDS    8              /* 64-bit words in a block */
+#define FILTER_MAGIC    "FSLBLOOM"
+#define FILTER_VERSION  1
+#define FILTER_HDR      32             /* Bytes in the saved header */
+
+/*
+** An odd multiplier that spreads the bits of a hash
+*/
+#define FILTER_MIX  0x9e3779b97f4a7c15ULL
+
+/*
+** Store in aMask[] the bits that the string of hash h sets in its
+** block, and return the index of the block.
+*/
+static u64 filterMask(const BlobFilter *p, u64 h, u64 *aMask){
+  u64 x = h * FILTER_MIX;
+  unsigned int i, pos;
+  memset(aMask, 0, FILTER_WORDS*sizeof(u64));
+  for(i=0; i<p->nHash; i++){
+    if( i>0 && i%7==0 ) x = (h ^ i) * FILTER_MIX;
+    pos = (unsigned int)(x>>55);
+    aMask[pos>>6] |= (u64)1<<(pos & 63);
+    x <<= 9;
+  }
+  return (u64)(((h & 0xffffffff) * p->nBlock) >> 32);
+}
+
+/*
+** Prepare an empty filter sized for nExpected strings at nBitsPerItem
+** bits each.  10 bits per item give a false positive rate of about 1%,
+** 16 bits about 0.1%.
+*/
+void blob_filter_init(BlobFilter *p, u64 nExpected, unsigned int nBitsPerItem){
+  if( nBitsPerItem<1 ) nBitsPerItem = 1;
+  p->nBlock = (nExpected*nBitsPerItem + 511)/512;
+  if( p->nBlock<1 ) p->nBlock = 1;
+  if( p->nBlock>0xffffffff ) p->nBlock = 0xffffffff;
+  /* About ln(2) bits set per bit of storage */
+  p->nHash = (nBitsPerItem*69 + 50)/100;
+  if( p->nHash<1 ) p->nHash = 1;
+  if( p->nHash>BLOB_FILTER_MAX_HASH ) p->nHash = BLOB_FILTER_MAX_HASH;
+  p->nItem = 0;
+  p->aBit = fossil_malloc( p->nBlock*FILTER_WORDS*sizeof(u64) );
+  memset(p->aBit, 0, p->nBlock*FILTER_WORDS*sizeof(u64));
+}
+
+/*
+** Free the memory of a filter.
+*/
+void blob_filter_free(BlobFilter *p){
+  fossil_free(p->aBit);
+  memset(p, 0, sizeof(*p));
+}
+
+/*
+** Add the n bytes at z to the filter.
+*/
+void blob_filter_add(BlobFilter *p, const char *z, blob_size_t n){
+  u64 aMask[FILTER_WORDS], *aBlock;
+  int i;
+  aBlock = p->aBit + filterMask(p, blob_map_hash(z, n), aMask)*FILTER_WORDS;
+  for(i=0; i<FILTER_WORDS; i++) aBlock[i] |= aMask[i];
+  p->nItem++;
+}
+
+/*
+** Return 0 if the n bytes at z were never added to the filter, or 1 if
+** they probably were.
+*/
+int blob_filter_test(const BlobFilter *p, const char *z, blob_size_t n){
+  u64 aMask[FILTER_WORDS], *aBlock, m = 0;
+  int i;
+  aBlock = p->aBit + filterMask(p, blob_map_hash(z, n), aMask)*FILTER_WORDS;
+  for(i=0; i<FILTER_WORDS; i++) m |= aMask[i] & ~aBlock[i];
+  return m==0;
+}
+
+/*
+** Write x as n little-endian bytes at z.
+*/
+static void filterPut(unsigned char *z, u64 x, int n){
+  int i;
+  for(i=0; i<n; i++) z[i] = (unsigned char)(x >> (8*i));
+}
+
+/*
+** Read n little-endian bytes at z.
+*/
+static u64 filterGet(const unsigned char *z, int n){
+  u64 x = 0;
+  while( n-- ) x = x<<8 | z[n];
+  return x;
+}
+
+/*
+** Append the filter to pOut in the saved format.  Nothing is appended
+** if a memory budget refuses the space.
+*/
+void blob_filter_save(const BlobFilter *p, Blob *pOut){
+  unsigned char aHdr[FILTER_HDR];
+  unsigned char *z;
+  u64 i, nWord = p->nBlock*FILTER_WORDS;
+  blob_size_t n0 = blob_size(pOut);
+  memcpy(aHdr, FILTER_MAGIC, 8);
+  filterPut(aHdr+8, FILTER_VERSION, 4);
+  filterPut(aHdr+12, p->nHash, 4);
+  filterPut(aHdr+16, p->nBlock, 8);
+  filterPut(aHdr+24, p->nItem, 8);
+  blob_append(pOut, (const char*)aHdr, FILTER_HDR);
+  z = (unsigned char*)blob_append_space(pOut, nWord*8);
+  if( z==0 ){
+    if( blob_size(pOut)>n0 ) blob_resize(pOut, n0);
+    return;
+  }
+  for(i=0; i<nWord; i++) filterPut(z + 8*i, p->aBit[i], 8);
+}
+
+/*
+** Initialize p from the n bytes at z, a filter saved by
+** blob_filter_save().  Return the number of bytes used, or 0 if they do
+** not hold a filter, in which case p is not initialized.
+*/
+blob_size_t blob_filter_load(BlobFilter *p, const char *z, blob_size_t n){
+  const unsigned char *a = (const unsigned char*)z;
+  u64 nBlock, i, nWord;
+  unsigned int nHash;
+  if( n<FILTER_HDR || memcmp(a, FILTER_MAGIC, 8)!=0
+   || filterGet(a+8, 4)!=FILTER_VERSION ){
+    return 0;
+  }
+  nHash = (unsigned int)filterGet(a+12, 4);
+  nBlock = filterGet(a+16, 8);
+  if( nHash<1 || nHash>BLOB_FILTER_MAX_HASH || nBlock<1
+   || nBlock>0xffffffff || nBlock > (n - FILTER_HDR)/(FILTER_WORDS*8) ){
+    return 0;
+  }
+  nWord = nBlock*FILTER_WORDS;
+  p->nHash = nHash;
+  p->nBlock = nBlock;
+  p->nItem = filterGet(a+24, 8);
+  p->aBit = fossil_malloc( nWord*sizeof(u64) );
+  for(i=0; i<nWord; i++) p->aBit[i] = filterGet(a + FILTER_HDR + 8*i, 8);
+  return (blob_size_t)(FILTER_HDR + nWord*8);
+}
@@ -27,17 +27,74 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/types.h>
 #include <time.h>
 
 typedef struct Blob Blob;
+typedef struct BlobAccount BlobAccount;
+typedef struct BlobArena BlobArena;
+typedef struct BlobArenaChunk BlobArenaChunk;
+typedef struct BlobCacheStats BlobCacheStats;
+typedef struct BlobChain BlobChain;
+typedef struct BlobChainSeg BlobChainSeg;
+typedef struct BlobDeflate BlobDeflate;
+typedef struct BlobFilter BlobFilter;
+typedef struct BlobIntern BlobIntern;
+typedef struct BlobInternHdr BlobInternHdr;
+typedef struct BlobMap BlobMap;
+typedef struct BlobMapEntry BlobMapEntry;
+typedef struct BlobReadReq BlobReadReq;
+typedef struct BlobSlice BlobSlice;
+typedef struct BlobSliceBuf BlobSliceBuf;
 typedef unsigned long long int u64;
 
+/*
+** Blob sizes are 32-bit by default, which keeps struct Blob small.
+** Build with -DFSL_BLOB64 ('make -DBLOB64') for size_t sizes and
+** blobs larger than 2GB.  blob_ssize_t is the signed counterpart used
+** for lengths where a negative value means "up to the first 0x00".
+*/
+
+/*
+** FSL_BLOB64 changes struct Blob and every size in this interface, so
+** programs must be built the same way as the library.  'make install'
+** rewrites FSL_BLOB64_BUILD in the installed copy of this header to 1
+** or 0, to match the library; -1 means that the choice is not recorded.
+*/
+#define FSL_BLOB64_BUILD -1
+#if FSL_BLOB64_BUILD==1 && !defined(FSL_BLOB64)
+# define FSL_BLOB64 1
+#elif FSL_BLOB64_BUILD==0 && defined(FSL_BLOB64)
+# error "libfslbase was built without FSL_BLOB64 ('make -DBLOB64')"
+#endif
+#ifdef FSL_BLOB64
+typedef size_t blob_size_t;
+typedef ssize_t blob_ssize_t;
+#else
+typedef unsigned int blob_size_t;
+typedef int blob_ssize_t;
+#endif
+
+/*
+** Maximum size of a Blob's managed memory. This is ~2GB, largely for
+** historical reasons.  Blobs built with FSL_BLOB64 are only limited
+** by the address space.
+**
+*/
+#ifdef FSL_BLOB64
+#define MAX_BLOB_SIZE 0x7fffffff00000000LL
+#else
+#define MAX_BLOB_SIZE 0x7fff0000
+#endif
+
 /*
 ** PRINTF
 */
 
 void fossil_puts(const char *z, int toStdErr, int n);
-int vxprintf(Blob *pBlob, const char *fmt, va_list ap);
+blob_ssize_t vxprintf(Blob *pBlob, const char *fmt, va_list ap);
+void vxprintf_cache_enable(int bEnable);
+int vxprintf_cache_count(void);
 char *mprintf(const char *zFormat, ...);
 char *vmprintf(const char *zFormat, va_list ap);
 
@@ -50,12 +107,12 @@ char *vmprintf(const char *zFormat, va_list ap);
 ** size changes as necessary.
 */
 struct Blob {
-  unsigned int nUsed;            /* Number of bytes used in aData[] */
-  unsigned int nAlloc;           /* Number of bytes allocated for aData[] */
-  unsigned int iCursor;          /* Next character of input to parse */
+  blob_size_t nUsed;             /* Number of bytes used in aData[] */
+  blob_size_t nAlloc;            /* Number of bytes allocated for aData[] */
+  blob_size_t iCursor;           /* Next character of input to parse */
   unsigned int blobFlags;        /* One or more BLOBFLAG_* bits */
   char *aData;                   /* Where the information is stored */
-  void (*xRealloc)(Blob*, unsigned int); /* Function to reallocate the buffer */
+  void (*xRealloc)(Blob*, blob_size_t); /* Function to reallocate the buffer */
 };
 
 /*
@@ -81,32 +138,463 @@ struct Blob {
 */
 #define blob_buffer(X)  ((X)->aData)
 
+/*
+** Number of bytes between the cursor and the end of a blob
+*/
+#define blob_unread(X)  ((X)->nUsed - (X)->iCursor)
+
+/*
+** Compare a blob to a string literal
+*/
+#define blob_eq(B,S) \
+     ((B)->nUsed==sizeof(S"")-1 && memcmp((B)->aData,S,sizeof(S)-1)==0)
+
 /*
 ** Make sure a blob is initialized
 */
 #define blob_is_init(x) \
-  assert((x)->xRealloc==blobReallocMalloc || (x)->xRealloc==blobReallocStatic)
+  assert((x)->xRealloc==blobReallocMalloc || (x)->xRealloc==blobReallocStatic \
+      || (x)->xRealloc==blobReallocArena || (x)->xRealloc==blobReallocChain \
+      || (x)->xRealloc==blobReallocMmap || (x)->xRealloc==blobReallocInline \
+      || (x)->xRealloc==blobReallocShared)
 
 #define BLOB_INITIALIZER  {0,0,0,0,0,blobReallocMalloc}
 
 #define BLOBFLAG_NotSQL  0x0001      /* Non-SQL text */
+#define BLOBFLAG_Account 0x0002      /* Buffer is counted, see blob_account */
+#define BLOBFLAG_OverBudget 0x0004   /* A budget refused a growth */
+#define BLOBFLAG_Category 0x0f00     /* Category the buffer is counted in */
+#define BLOBFLAG_CATEGORY_SHIFT 8
+
+#define BLOB_PAGE_SIZE   4096        /* Rounding unit of blobGrowPage() */
+#define BLOB_COMPACT_MIN 1024        /* Smallest prefix blob_consume() moves */
+
+/*
+** A growth policy returns the new allocation size for a blob whose
+** buffer holds nAlloc bytes and must now hold more than nNeed bytes.
+*/
+typedef u64 (*BlobGrowFunc)(u64 nAlloc, u64 nNeed);
+
+/*
+** Buffers between BLOB_CACHE_MIN and BLOB_CACHE_MAX bytes, in powers of
+** two, are kept by the per-thread cache of blob_cache_enable().
+*/
+#define BLOB_CACHE_MIN   64
+#define BLOB_CACHE_MAX   (1<<20)
+
+/*
+** Bytes of blob buffers held in one accounting category.  The category
+** of a buffer is the one current on the thread that allocated it, see
+** blob_account_category().
+*/
+#define BLOB_ACCOUNT_NCAT  16
+
+struct BlobAccount {
+  u64 nCur;                      /* Bytes held now */
+  u64 nPeak;                     /* Most bytes held at once */
+  u64 nAlloc;                    /* Buffers allocated or grown */
+  u64 mxSoft;                    /* Soft budget, or 0 */
+  u64 mxHard;                    /* Hard budget, or 0 */
+};
+
+/*
+** A budget callback.  eBudget is BLOB_BUDGET_SOFT once category iCat,
+** holding nCur bytes, is about to cross its soft budget by allocating
+** nMore bytes; the return value is then ignored.  It is BLOB_BUDGET_HARD
+** when the allocation would cross the hard budget: return nonzero after
+** freeing memory or raising the budget to check again, 0 to let the
+** program exit, or BLOB_BUDGET_FAIL to refuse the allocation.  A callback
+** may also longjmp() out to a recovery point, leaving the blob being
+** grown unchanged.
+**
+** A refused allocation leaves the blob as it was and sets its sticky
+** BLOBFLAG_OverBudget, tested with blob_over_budget() and cleared by
+** blob_over_budget_clear() or blob_reset().  The write that needed the
+** space is dropped: blob_append() and vxprintf() append nothing more,
+** blob_resize(), blob_reserve() and the routines that build a whole
+** blob return their error code, and blob_append_space() returns NULL.
+*/
+#define BLOB_BUDGET_SOFT  1
+#define BLOB_BUDGET_HARD  2
+#define BLOB_BUDGET_FAIL  (-1)
+
+#define blob_over_budget(X)  (((X)->blobFlags & BLOBFLAG_OverBudget)!=0)
+#define blob_over_budget_clear(X)  ((X)->blobFlags &= ~BLOBFLAG_OverBudget)
+
+typedef int (*BlobBudgetFunc)(void *pArg, int iCat, int eBudget, u64 nCur,
+                              u64 nMore);
+
+/*
+** Counters of the buffer cache of the calling thread
+*/
+struct BlobCacheStats {
+  u64 nHit;                      /* Buffers taken from the cache */
+  u64 nMalloc;                   /* Buffers the cache got from malloc() */
+  u64 nFree;                     /* Buffers the cache gave to free() */
+  u64 nCached;                   /* Bytes held by the cache now */
+};
 
 extern const Blob empty_blob;
 
 char *blob_str(Blob *p);
 char *blob_materialize(Blob *pBlob);
-void blob_append(Blob *pBlob, const char *aData, int nData);
+int blob_compare(Blob *pA, Blob *pB);
+int blob_eq_str(Blob *pBlob, const char *z, blob_ssize_t n);
+blob_ssize_t blob_find(Blob *pBlob, const char *zNeedle, blob_ssize_t nNeedle);
+blob_ssize_t blob_find_last(Blob *pBlob, const char *zNeedle,
+                            blob_ssize_t nNeedle);
+void blob_append(Blob *pBlob, const char *aData, blob_ssize_t nData);
 void blob_append_char(Blob *pBlob, char c);
-void blobReallocMalloc(Blob *pBlob, unsigned int newSize);
-void blob_resize(Blob *pBlob, unsigned int newSize);
-int blob_read_from_channel(Blob *pBlob, FILE *in, int nToRead);
+char *blob_append_space(Blob *pBlob, blob_size_t n);
+void blobReallocMalloc(Blob *pBlob, blob_size_t newSize);
+int blob_resize(Blob *pBlob, blob_size_t newSize);
+int blob_reserve(Blob *pBlob, blob_size_t n);
+u64 blobGrowDefault(u64 nAlloc, u64 nNeed);
+u64 blobGrowDouble(u64 nAlloc, u64 nNeed);
+u64 blobGrowOneHalf(u64 nAlloc, u64 nNeed);
+u64 blobGrowPage(u64 nAlloc, u64 nNeed);
+BlobGrowFunc blob_set_growth(BlobGrowFunc xGrow);
+void blob_cache_enable(u64 mxBytes);
+void blob_cache_flush(void);
+void blob_cache_stats(BlobCacheStats *p);
+void blob_account_enable(BlobBudgetFunc xBudget, void *pArg);
+int blob_account_category(int iCat);
+void blob_account_budget(int iCat, u64 mxSoft, u64 mxHard);
+void blob_account_get(int iCat, BlobAccount *p);
+void blob_compact(Blob *pBlob);
+char *blob_peek(Blob *pBlob, blob_size_t n);
+blob_size_t blob_consume(Blob *pBlob, char *aOut, blob_size_t n);
+void blob_fifo_init(Blob *pBlob, blob_size_t nCap);
+blob_size_t blob_fifo_write(Blob *pBlob, const char *aData, blob_size_t n);
+blob_size_t blob_extract(Blob *pFrom, blob_size_t N, Blob *pTo);
+blob_size_t blob_line(Blob *pFrom, Blob *pTo);
+int blob_split_lines(Blob *pFrom, Blob *aLine, int nLine);
+blob_size_t blob_trim(Blob *p);
+blob_size_t blob_token(Blob *pFrom, Blob *pTo);
+blob_ssize_t blob_read_from_channel(Blob *pBlob, FILE *in,
+                                    blob_ssize_t nToRead);
 void blob_zero(Blob *pBlob);
 void blob_vappendf(Blob *pBlob, const char *zFormat, va_list ap);
 void blob_reset(Blob *pBlob);
-void blob_init(Blob *pBlob, const char *zData, int size);
+void blob_init(Blob *pBlob, const char *zData, blob_ssize_t size);
+void blob_init_inline(Blob *pBlob, char *aSpace, blob_size_t nSpace);
+void blobReallocInline(Blob *pBlob, blob_size_t newSize);
 void blob_append_sql(Blob *pBlob, const char *zFormat, ...);
 char *blob_sql_text(Blob *p);
 
+/*
+** ARENA
+*/
+
+/*
+** A region allocator for Blobs.  Initialize with BLOB_ARENA_INITIALIZER
+** or blob_arena_init(), then attach blobs with blob_init_arena().
+*/
+struct BlobArena {
+  BlobArenaChunk *pChunk;        /* Most recent chunk.  Blocks come from here */
+  unsigned int szChunk;          /* Size of a new chunk */
+  unsigned int nMalloc;          /* Number of chunks obtained from malloc() */
+};
+
+#define BLOB_ARENA_CHUNK  65536   /* Default chunk size */
+
+#define BLOB_ARENA_INITIALIZER  {0,BLOB_ARENA_CHUNK,0}
+
+void blob_arena_init(BlobArena *p, unsigned int szChunk);
+void blob_init_arena(Blob *pBlob, BlobArena *p);
+void *blob_arena_alloc(BlobArena *p, blob_size_t nByte);
+void blobReallocArena(Blob *pBlob, blob_size_t newSize);
+void blob_arena_reset(BlobArena *p);
+void blob_arena_free(BlobArena *p);
+
+/*
+** CHAIN
+*/
+
+/*
+** An append-only blob kept as a list of segments.  The tail must be
+** the first field, blobReallocChain() depends on it.
+*/
+struct BlobChain {
+  Blob tail;                     /* Segment being appended to */
+  BlobChainSeg *pFirst, *pLast;  /* Full segments, oldest first */
+  u64 nPrior;                    /* Bytes of content in full segments */
+  unsigned int szSeg;            /* Size of a new segment */
+};
+
+#define BLOB_CHAIN_SEGMENT  65536   /* Default segment size */
+
+/*
+** The total size of a BlobChain, which may be more than a Blob holds
+*/
+#define blob_chain_size(X)  ((X)->nPrior + (X)->tail.nUsed)
+
+void blob_chain_init(BlobChain *p, unsigned int szSeg);
+void blobReallocChain(Blob *pBlob, blob_size_t newSize);
+int blob_chain_flatten(BlobChain *p);
+void blob_chain_reset(BlobChain *p);
+void blob_chain_append(BlobChain *p, const char *aData, blob_ssize_t nData);
+void blob_chain_appendf(BlobChain *p, const char *zFormat, ...);
+off_t blob_chain_write(BlobChain *p, int fd);
+
+/*
+** MAP
+*/
+
+/*
+** An entry of a BlobMap.  zKey is not copied.
+*/
+struct BlobMapEntry {
+  const char *zKey;              /* Key */
+  u64 h;                         /* blob_map_hash() of the key */
+  blob_size_t nKey;              /* Bytes in zKey */
+  void *pValue;                  /* Value, NULL in a new entry */
+};
+
+/*
+** A hash map from byte strings to pointers.  Initialize with
+** BLOB_MAP_INITIALIZER or blob_map_init().
+*/
+struct BlobMap {
+  unsigned char *aCtrl;          /* Control byte of each slot */
+  BlobMapEntry *aEntry;          /* Entry of each slot */
+  u64 nSlot;                     /* Number of slots, a power of two */
+  u64 nUsed;                     /* Number of entries */
+  u64 nGrowth;                   /* Empty slots left to fill before rehash */
+};
+
+#define BLOB_MAP_INITIALIZER  {0,0,0,0,0}
+
+/*
+** The number of entries in a map, and lookups keyed by a Blob
+*/
+#define blob_map_count(M)          ((M)->nUsed)
+#define blob_map_find_blob(M,B)    blob_map_find(M,blob_buffer(B),blob_size(B))
+#define blob_map_insert_blob(M,B,P) \
+  blob_map_insert(M,blob_buffer(B),blob_size(B),P)
+#define blob_map_erase_blob(M,B)   blob_map_erase(M,blob_buffer(B),blob_size(B))
+
+u64 blob_map_hash(const char *z, blob_size_t n);
+void blob_map_init(BlobMap *p);
+void blob_map_free(BlobMap *p);
+void blob_map_reserve(BlobMap *p, u64 n);
+BlobMapEntry *blob_map_find(BlobMap *p, const char *zKey, blob_size_t nKey);
+BlobMapEntry *blob_map_insert(BlobMap *p, const char *zKey,
+                              blob_size_t nKey, int *pbNew);
+int blob_map_erase(BlobMap *p, const char *zKey, blob_size_t nKey);
+void blob_map_erase_entry(BlobMap *p, BlobMapEntry *pE);
+BlobMapEntry *blob_map_next(BlobMap *p, BlobMapEntry *pE);
+
+/*
+** INTERN
+*/
+
+/*
+** A pool of unique strings.  Initialize with BLOB_INTERN_INITIALIZER
+** or blob_intern_init().
+*/
+struct BlobIntern {
+  BlobArena arena;               /* Holds the strings */
+  BlobMap map;                   /* Finds them by content */
+};
+
+#define BLOB_INTERN_INITIALIZER  {BLOB_ARENA_INITIALIZER,BLOB_MAP_INITIALIZER}
+
+/*
+** Header in front of each string of a pool
+*/
+struct BlobInternHdr {
+  u64 h;                         /* blob_map_hash() of the string */
+  blob_size_t n;                 /* Bytes in the string */
+};
+
+/*
+** The length and hash of a string returned by blob_intern(), and the
+** number of strings in a pool
+*/
+#define blob_intern_hdr(Z)    ((const BlobInternHdr*)(Z) - 1)
+#define blob_intern_len(Z)    (blob_intern_hdr(Z)->n)
+#define blob_intern_hash(Z)   (blob_intern_hdr(Z)->h)
+#define blob_intern_count(P)  blob_map_count(&(P)->map)
+#define blob_intern_blob(P,B) blob_intern(P, blob_buffer(B), blob_size(B))
+
+void blob_intern_init(BlobIntern *p);
+void blob_intern_free(BlobIntern *p);
+const char *blob_intern(BlobIntern *p, const char *z, blob_ssize_t n);
+
+/*
+** MMAP
+*/
+
+/*
+** Access pattern hints for blob_init_mmap() and blob_mmap_advise()
+*/
+#define BLOB_MMAP_NORMAL      0
+#define BLOB_MMAP_SEQUENTIAL  1
+#define BLOB_MMAP_RANDOM      2
+#define BLOB_MMAP_WILLNEED    3
+
+void blobReallocMmap(Blob *pBlob, blob_size_t newSize);
+void blobMmapAdvance(Blob *pBlob, blob_size_t n);
+void blob_mmap_advise(Blob *pBlob, int eAdvice);
+blob_ssize_t blob_init_mmap(Blob *pBlob, int fd, int eAdvice);
+blob_ssize_t blob_read_mmap(Blob *pBlob, const char *zFilename, int eAdvice);
+
+/*
+** SLICE
+*/
+
+/*
+** A blob that views all or part of a buffer shared with other slices.
+** The blob must be the first field, blobReallocShared() depends on it.
+** Pass &BlobSlice.b to the blob interfaces, and do not copy the struct.
+*/
+struct BlobSlice {
+  Blob b;                        /* The view */
+  BlobSliceBuf *pBuf;            /* Shared buffer, or 0 once written to */
+};
+
+void blobReallocShared(Blob *pBlob, blob_size_t newSize);
+void blob_slice_init(BlobSlice *p, Blob *pFrom);
+void blob_slice(BlobSlice *pTo, BlobSlice *pFrom, blob_size_t iOfst,
+                blob_size_t n);
+int blob_slice_refs(BlobSlice *p);
+
+/*
+** FILE
+*/
+struct iovec;
+int file_writev(int fd, struct iovec *a, int n);
+off_t blob_writev(int fd, Blob **ap, int n);
+blob_ssize_t blob_write_to_fd(Blob *pBlob, int fd);
+blob_ssize_t blob_read_from_file(Blob *pBlob, const char *zFilename);
+blob_ssize_t blob_write_to_file(Blob *pBlob, const char *zFilename);
+off_t file_copy(const char *zFrom, const char *zTo);
+
+/*
+** One file of a batch read by blob_read_batch()
+*/
+struct BlobReadReq {
+  const char *zFilename;         /* File to read */
+  Blob *pBlob;                   /* Receives the content, must be reset */
+  int rc;                        /* Set to 0, or errno if the read failed */
+};
+
+#define BLOB_READ_DEPTH      8   /* Reads in flight by default */
+#define BLOB_READ_MAX_DEPTH  64  /* Most reads in flight */
+
+typedef void (*BlobReadFunc)(void *pArg, BlobReadReq *pReq);
+
+int blob_read_batch(BlobReadReq *a, int n, int nDepth, BlobReadFunc xDone,
+                    void *pArg);
+
+/*
+** COMPRESS
+*/
+
+/*
+** A compressor that appends its output to a blob as input arrives
+*/
+struct BlobDeflate {
+  Blob *pOut;                    /* Compressed content is appended here */
+  blob_size_t iHeader;           /* Offset of the size header in pOut */
+  u64 nIn;                       /* Bytes of input so far */
+  void *pStream;                 /* zlib stream state */
+};
+
+int blob_compress(Blob *pIn, Blob *pOut);
+int blob_compress_level(Blob *pIn, Blob *pOut, int level);
+int blob_uncompress(Blob *pIn, Blob *pOut);
+int blob_deflate_init(BlobDeflate *p, Blob *pOut, int level);
+int blob_deflate_append(BlobDeflate *p, const char *aData, blob_ssize_t nData);
+int blob_deflate_finish(BlobDeflate *p);
+
+/*
+** DELTA
+*/
+int delta_create(const char *zSrc, unsigned int lenSrc,
+                 const char *zOut, unsigned int lenOut, char *zDelta);
+int delta_output_size(const char *zDelta, int lenDelta);
+int delta_apply(const char *zSrc, int lenSrc,
+                const char *zDelta, int lenDelta, char *zOut);
+int blob_delta_create(Blob *pOriginal, Blob *pTarget, Blob *pDelta);
+int blob_delta_apply(Blob *pOriginal, Blob *pDelta, Blob *pTarget);
+
+/*
+** ENCODE
+*/
+void encode16(const unsigned char *pIn, unsigned char *zOut, blob_size_t N);
+int decode16(const unsigned char *zIn, unsigned char *pOut, blob_size_t N);
+void blob_encode16(Blob *pBlob, const char *aData, blob_ssize_t nData);
+int blob_decode16(Blob *pBlob, const char *zHex16, blob_ssize_t n);
+void blob_encode64(Blob *pBlob, const char *aData, blob_ssize_t nData);
+int blob_decode64(Blob *pBlob, const char *z64, blob_ssize_t n);
+
+/*
+** FILTER
+*/
+
+/*
+** A Bloom filter over byte strings, see blob_filter_init()
+*/
+struct BlobFilter {
+  u64 *aBit;                     /* nBlock blocks of 512 bits */
+  u64 nBlock;                    /* Number of blocks */
+  u64 nItem;                     /* Strings added */
+  unsigned int nHash;            /* Bits set per string */
+};
+
+#define BLOB_FILTER_MAX_HASH  16
+
+/*
+** Add or test the content of a Blob
+*/
+#define blob_filter_add_blob(F,B) \
+  blob_filter_add(F,blob_buffer(B),blob_size(B))
+#define blob_filter_test_blob(F,B) \
+  blob_filter_test(F,blob_buffer(B),blob_size(B))
+
+void blob_filter_init(BlobFilter *p, u64 nExpected, unsigned int nBitsPerItem);
+void blob_filter_free(BlobFilter *p);
+void blob_filter_add(BlobFilter *p, const char *z, blob_size_t n);
+int blob_filter_test(const BlobFilter *p, const char *z, blob_size_t n);
+void blob_filter_save(const BlobFilter *p, Blob *pOut);
+blob_size_t blob_filter_load(BlobFilter *p, const char *z, blob_size_t n);
+
+/*
+** HASH
+*/
+#define HNAME_ALG_SHA1  0        /* SHA1 */
+#define HNAME_ALG_K256  1        /* SHA3-256 */
+
+#define HNAME_BATCH_THREADS      4   /* Threads used by default */
+#define HNAME_BATCH_MAX_THREADS  64  /* Most threads used */
+
+int sha1sum_blob(const Blob *pIn, Blob *pCksum);
+void sha3sum_blob(const Blob *pIn, int iSize, Blob *pCksum);
+int hname_hash(const Blob *pContent, unsigned int iHType, Blob *pHashOut);
+int hname_hash_batch(Blob **apIn, Blob *aOut, int n, unsigned int iHType,
+                     int nThread);
+
+/*
+** SCAN
+*/
+blob_size_t scan_newline(const char *z, blob_size_t n);
+blob_size_t scan_space(const char *z, blob_size_t n);
+blob_size_t scan_nonspace(const char *z, blob_size_t n);
+blob_size_t scan_find(const char *z, blob_size_t n,
+                      const char *zNeedle, blob_size_t m);
+blob_size_t scan_find_last(const char *z, blob_size_t n,
+                           const char *zNeedle, blob_size_t m);
+
+/*
+** TEXT
+*/
+int blob_is_utf8(Blob *pBlob);
+void blob_remove_cr(Blob *pBlob);
+void blob_to_lf_only(Blob *pBlob);
+int fossil_all_whitespace(const char *z);
+
 /*
 ** UTIL
 */
@@ -116,6 +604,6 @@ char *fossil_strdup_nn(const char *zOrig);
 void *fossil_malloc(size_t n);
 void fossil_free(void *p);
 void *fossil_realloc(void *p, size_t n);
-int fossil_all_whitespace(const char *z);
+int fossil_isspace(char c);
 
 #endif
@@ -0,0 +1,440 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** Artifact hashes: SHA1 and SHA3 computed straight over the content of
+** a blob, as lower-case hexadecimal like Fossil's sha1sum_blob() and
+** sha3sum_blob().
+**
+** SHA1 uses the SHA extensions of the CPU when it has them.  Unlike
+** Fossil, this is plain SHA1 without the SHA1DC collision detection.
+** SHA3 is the Keccak-f[1600] permutation of FIPS 202.
+*/
+
+#include <pthread.h>
+
+#include "fslbase.h"
+#include "simd.h"
+
+typedef unsigned int u32;
+
+/*
+** State of a SHA1 computation
+*/
+typedef struct Sha1 Sha1;
+struct Sha1 {
+  u32 s[5];                      /* Chaining value */
+};
+
+#define ROL32(x,n)  ((x)<<(n) | (x)>>(32-(n)))
+
+/*
+** Read a big-endian 32-bit word.
+*/
+static u32 get32be(const unsigned char *p){
+  return (u32)p[0]<<24 | (u32)p[1]<<16 | (u32)p[2]<<8 | p[3];
+}
+
+/*
+** The round functions of SHA1 and one round of the portable code, in
+** which the roles of a..e rotate from one round to the next.  Message
+** words are scheduled in a circular buffer of 16.
+*/
+#define SHA1_F0(b,c,d)  ((d) ^ ((b) & ((c) ^ (d))))
+#define SHA1_F1(b,c,d)  ((b) ^ (c) ^ (d))
+#define SHA1_F2(b,c,d)  (((b) & (c)) | ((d) & ((b) | (c))))
+#define SHA1_W(i) \
+  ((i)<16 ? w[i] : (t = w[((i)+13)&15] ^ w[((i)+8)&15] ^ w[((i)+2)&15] \
+                        ^ w[(i)&15], w[(i)&15] = ROL32(t, 1)))
+#define SHA1_ROUND(f,k,a,b,c,d,e,i) \
+  e += ROL32(a, 5) + f(b,c,d) + k + SHA1_W(i); b = ROL32(b, 30)
+#define SHA1_ROUND5(f,k,i) \
+  SHA1_ROUND(f, k, a, b, c, d, e, (i)); \
+  SHA1_ROUND(f, k, e, a, b, c, d, (i)+1); \
+  SHA1_ROUND(f, k, d, e, a, b, c, (i)+2); \
+  SHA1_ROUND(f, k, c, d, e, a, b, (i)+3); \
+  SHA1_ROUND(f, k, b, c, d, e, a, (i)+4)
+
+/*
+** Process nBlock 64-byte blocks with portable code.
+*/
+static void sha1Blocks(Sha1 *p, const unsigned char *z, size_t nBlock){
+  u32 w[16], a, b, c, d, e, t;
+  int i;
+  while( nBlock-- ){
+    for(i=0; i<16; i++) w[i] = get32be(z + 4*i);
+    a = p->s[0]; b = p->s[1]; c = p->s[2]; d = p->s[3]; e = p->s[4];
+    for(i=0; i<20; i+=5){ SHA1_ROUND5(SHA1_F0, 0x5a827999, i); }
+    for(i=20; i<40; i+=5){ SHA1_ROUND5(SHA1_F1, 0x6ed9eba1, i); }
+    for(i=40; i<60; i+=5){ SHA1_ROUND5(SHA1_F2, 0x8f1bbcdc, i); }
+    for(i=60; i<80; i+=5){ SHA1_ROUND5(SHA1_F1, 0xca62c1d6, i); }
+    p->s[0] += a; p->s[1] += b; p->s[2] += c; p->s[3] += d; p->s[4] += e;
+    z += 64;
+  }
+}
+
+#ifdef FSL_SHA
+/*
+** Four rounds of SHA1 with the SHA extensions: group g of the 20, with
+** round function f.  Ec holds the E value and message words for these
+** rounds and Eo receives the next E.  Mc holds the message words of
+** this group; the next three groups are scheduled into Mn, Mx and Mp.
+*/
+#define SHA1_NI_ROUNDS(g, f, Ec, Eo, Mc, Mn, Mx, Mp) \
+  Ec = (g)==0 ? _mm_add_epi32(Ec, Mc) : _mm_sha1nexte_epu32(Ec, Mc); \
+  Eo = abcd; \
+  if( (g)>=3 && (g)<=18 ) Mn = _mm_sha1msg2_epu32(Mn, Mc); \
+  abcd = _mm_sha1rnds4_epu32(abcd, Ec, f); \
+  if( (g)>=1 && (g)<=16 ) Mp = _mm_sha1msg1_epu32(Mp, Mc); \
+  if( (g)>=2 && (g)<=17 ) Mx = _mm_xor_si128(Mx, Mc)
+
+/*
+** Process nBlock 64-byte blocks with the SHA extensions.
+*/
+FSL_TARGET_SHA
+static void sha1BlocksNi(Sha1 *p, const unsigned char *z, size_t nBlock){
+  const __m128i mask = _mm_set_epi64x(0x0001020304050607LL,
+                                      0x08090a0b0c0d0e0fLL);
+  __m128i abcd, abcdSave, e0, e0Save, e1, m0, m1, m2, m3;
+  abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)p->s), 0x1b);
+  e0 = _mm_set_epi32((int)p->s[4], 0, 0, 0);
+  while( nBlock-- ){
+    abcdSave = abcd;
+    e0Save = e0;
+    m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)z), mask);
+    m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(z+16)), mask);
+    m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(z+32)), mask);
+    m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(z+48)), mask);
+    SHA1_NI_ROUNDS( 0, 0, e0, e1, m0, m1, m2, m3);
+    SHA1_NI_ROUNDS( 1, 0, e1, e0, m1, m2, m3, m0);
+    SHA1_NI_ROUNDS( 2, 0, e0, e1, m2, m3, m0, m1);
+    SHA1_NI_ROUNDS( 3, 0, e1, e0, m3, m0, m1, m2);
+    SHA1_NI_ROUNDS( 4, 0, e0, e1, m0, m1, m2, m3);
+    SHA1_NI_ROUNDS( 5, 1, e1, e0, m1, m2, m3, m0);
+    SHA1_NI_ROUNDS( 6, 1, e0, e1, m2, m3, m0, m1);
+    SHA1_NI_ROUNDS( 7, 1, e1, e0, m3, m0, m1, m2);
+    SHA1_NI_ROUNDS( 8, 1, e0, e1, m0, m1, m2, m3);
+    SHA1_NI_ROUNDS( 9, 1, e1, e0, m1, m2, m3, m0);
+    SHA1_NI_ROUNDS(10, 2, e0, e1, m2, m3, m0, m1);
+    SHA1_NI_ROUNDS(11, 2, e1, e0, m3, m0, m1, m2);
+    SHA1_NI_ROUNDS(12, 2, e0, e1, m0, m1, m2, m3);
+    SHA1_NI_ROUNDS(13, 2, e1, e0, m1, m2, m3, m0);
+    SHA1_NI_ROUNDS(14, 2, e0, e1, m2, m3, m0, m1);
+    SHA1_NI_ROUNDS(15, 3, e1, e0, m3, m0, m1, m2);
+    SHA1_NI_ROUNDS(16, 3, e0, e1, m0, m1, m2, m3);
+    SHA1_NI_ROUNDS(17, 3, e1, e0, m1, m2, m3, m0);
+    SHA1_NI_ROUNDS(18, 3, e0, e1, m2, m3, m0, m1);
+    SHA1_NI_ROUNDS(19, 3, e1, e0, m3, m0, m1, m2);
+    e0 = _mm_sha1nexte_epu32(e0, e0Save);
+    abcd = _mm_add_epi32(abcd, abcdSave);
+    z += 64;
+  }
+  _mm_storeu_si128((__m128i*)p->s, _mm_shuffle_epi32(abcd, 0x1b));
+  p->s[4] = (u32)_mm_extract_epi32(e0, 3);
+}
+#endif /* FSL_SHA */
+
+/*
+** The block function chosen for this CPU on first use
+*/
+static void (*xSha1Blocks)(Sha1*, const unsigned char*, size_t) = 0;
+
+/*
+** Store the SHA1 hash of the n bytes at z, as 20 bytes, in aOut.
+*/
+static void sha1Hash(const unsigned char *z, size_t n, unsigned char *aOut){
+  Sha1 ctx = {{ 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476,
+                0xc3d2e1f0 }};
+  unsigned char aLast[128];
+  size_t nFull = n/64, nTail = n%64, nLast;
+  u64 nBit = (u64)n*8;
+  void (*xBlocks)(Sha1*, const unsigned char*, size_t);
+  int i;
+  xBlocks = __atomic_load_n(&xSha1Blocks, __ATOMIC_RELAXED);
+  if( xBlocks==0 ){
+    xBlocks = sha1Blocks;
+#ifdef FSL_SHA
+    if( fsl_cpu_sha() ) xBlocks = sha1BlocksNi;
+#endif
+    __atomic_store_n(&xSha1Blocks, xBlocks, __ATOMIC_RELAXED);
+  }
+  xBlocks(&ctx, z, nFull);
+  nLast = nTail<56 ? 64 : 128;
+  memset(aLast, 0, nLast);
+  if( nTail ) memcpy(aLast, z + nFull*64, nTail);
+  aLast[nTail] = 0x80;
+  for(i=0; i<8; i++) aLast[nLast-1-i] = (unsigned char)(nBit >> (8*i));
+  xBlocks(&ctx, aLast, nLast/64);
+  for(i=0; i<20; i++) aOut[i] = (unsigned char)(ctx.s[i/4] >> (24-8*(i%4)));
+}
+
+/*
+** Round constants of Keccak-f[1600]
+*/
+static const u64 aKeccakRc[24] = {
+  0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+  0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+  0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+  0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+  0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+  0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+  0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+  0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+#define ROL64(x,n)  ((x)<<(n) | (x)>>(64-(n)))
+
+/*
+** Apply the Keccak-f[1600] permutation to the 25 lanes of s[].  Each
+** round is unrolled, with theta, rho and pi done in one pass.
+*/
+static void keccakF1600(u64 *s){
+  u64 a00, a01, a02, a03, a04, a05, a06, a07, a08, a09, a10, a11, a12,
+      a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24;
+  u64 b00, b01, b02, b03, b04, b05, b06, b07, b08, b09, b10, b11, b12,
+      b13, b14, b15, b16, b17, b18, b19, b20, b21, b22, b23, b24;
+  u64 c0, c1, c2, c3, c4, d0, d1, d2, d3, d4;
+  int r;
+  a00 = s[0]; a01 = s[1]; a02 = s[2]; a03 = s[3]; a04 = s[4];
+  a05 = s[5]; a06 = s[6]; a07 = s[7]; a08 = s[8]; a09 = s[9];
+  a10 = s[10]; a11 = s[11]; a12 = s[12]; a13 = s[13]; a14 = s[14];
+  a15 = s[15]; a16 = s[16]; a17 = s[17]; a18 = s[18]; a19 = s[19];
+  a20 = s[20]; a21 = s[21]; a22 = s[22]; a23 = s[23]; a24 = s[24];
+  for(r=0; r<24; r++){
+    c0 = a00 ^ a05 ^ a10 ^ a15 ^ a20;
+    c1 = a01 ^ a06 ^ a11 ^ a16 ^ a21;
+    c2 = a02 ^ a07 ^ a12 ^ a17 ^ a22;
+    c3 = a03 ^ a08 ^ a13 ^ a18 ^ a23;
+    c4 = a04 ^ a09 ^ a14 ^ a19 ^ a24;
+    d0 = c4 ^ ROL64(c1, 1);
+    d1 = c0 ^ ROL64(c2, 1);
+    d2 = c1 ^ ROL64(c3, 1);
+    d3 = c2 ^ ROL64(c4, 1);
+    d4 = c3 ^ ROL64(c0, 1);
+    b00 = a00 ^ d0;
+    b10 = ROL64(a01 ^ d1, 1);
+    b20 = ROL64(a02 ^ d2, 62);
+    b05 = ROL64(a03 ^ d3, 28);
+    b15 = ROL64(a04 ^ d4, 27);
+    b16 = ROL64(a05 ^ d0, 36);
+    b01 = ROL64(a06 ^ d1, 44);
+    b11 = ROL64(a07 ^ d2, 6);
+    b21 = ROL64(a08 ^ d3, 55);
+    b06 = ROL64(a09 ^ d4, 20);
+    b07 = ROL64(a10 ^ d0, 3);
+    b17 = ROL64(a11 ^ d1, 10);
+    b02 = ROL64(a12 ^ d2, 43);
+    b12 = ROL64(a13 ^ d3, 25);
+    b22 = ROL64(a14 ^ d4, 39);
+    b23 = ROL64(a15 ^ d0, 41);
+    b08 = ROL64(a16 ^ d1, 45);
+    b18 = ROL64(a17 ^ d2, 15);
+    b03 = ROL64(a18 ^ d3, 21);
+    b13 = ROL64(a19 ^ d4, 8);
+    b14 = ROL64(a20 ^ d0, 18);
+    b24 = ROL64(a21 ^ d1, 2);
+    b09 = ROL64(a22 ^ d2, 61);
+    b19 = ROL64(a23 ^ d3, 56);
+    b04 = ROL64(a24 ^ d4, 14);
+    a00 = b00 ^ (~b01 & b02);
+    a01 = b01 ^ (~b02 & b03);
+    a02 = b02 ^ (~b03 & b04);
+    a03 = b03 ^ (~b04 & b00);
+    a04 = b04 ^ (~b00 & b01);
+    a05 = b05 ^ (~b06 & b07);
+    a06 = b06 ^ (~b07 & b08);
+    a07 = b07 ^ (~b08 & b09);
+    a08 = b08 ^ (~b09 & b05);
+    a09 = b09 ^ (~b05 & b06);
+    a10 = b10 ^ (~b11 & b12);
+    a11 = b11 ^ (~b12 & b13);
+    a12 = b12 ^ (~b13 & b14);
+    a13 = b13 ^ (~b14 & b10);
+    a14 = b14 ^ (~b10 & b11);
+    a15 = b15 ^ (~b16 & b17);
+    a16 = b16 ^ (~b17 & b18);
+    a17 = b17 ^ (~b18 & b19);
+    a18 = b18 ^ (~b19 & b15);
+    a19 = b19 ^ (~b15 & b16);
+    a20 = b20 ^ (~b21 & b22);
+    a21 = b21 ^ (~b22 & b23);
+    a22 = b22 ^ (~b23 & b24);
+    a23 = b23 ^ (~b24 & b20);
+    a24 = b24 ^ (~b20 & b21);
+    a00 ^= aKeccakRc[r];
+  }
+  s[0] = a00; s[1] = a01; s[2] = a02; s[3] = a03; s[4] = a04;
+  s[5] = a05; s[6] = a06; s[7] = a07; s[8] = a08; s[9] = a09;
+  s[10] = a10; s[11] = a11; s[12] = a12; s[13] = a13; s[14] = a14;
+  s[15] = a15; s[16] = a16; s[17] = a17; s[18] = a18; s[19] = a19;
+  s[20] = a20; s[21] = a21; s[22] = a22; s[23] = a23; s[24] = a24;
+}
+
+/*
+** XOR nByte bytes of z into the lanes of s[], little-endian.
+*/
+static void keccakAbsorb(u64 *s, const unsigned char *z, int nByte){
+  int i;
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__!=__ORDER_LITTLE_ENDIAN__
+  int k;
+#endif
+  u64 x;
+  for(i=0; i<nByte/8; i++){
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__==__ORDER_LITTLE_ENDIAN__
+    memcpy(&x, z + 8*i, 8);
+#else
+    x = 0;
+    for(k=7; k>=0; k--) x = x<<8 | z[8*i+k];
+#endif
+    s[i] ^= x;
+  }
+}
+
+/*
+** Store the SHA3 hash of iSize bits of the n bytes at z in aOut.
+*/
+static void sha3Hash(const unsigned char *z, size_t n, int iSize,
+                     unsigned char *aOut){
+  u64 s[25];
+  unsigned char aLast[200];
+  int nRate = 200 - iSize/4;
+  int i;
+  memset(s, 0, sizeof(s));
+  while( n>=(size_t)nRate ){
+    keccakAbsorb(s, z, nRate);
+    keccakF1600(s);
+    z += nRate;
+    n -= nRate;
+  }
+  memset(aLast, 0, nRate);
+  if( n ) memcpy(aLast, z, n);
+  aLast[n] = 0x06;
+  aLast[nRate-1] |= 0x80;
+  keccakAbsorb(s, aLast, nRate);
+  keccakF1600(s);
+  for(i=0; i<iSize/8; i++) aOut[i] = (unsigned char)(s[i/8] >> (8*(i%8)));
+}
+
+/*
+** Store nByte bytes of aHash in pCksum as hexadecimal.  pCksum may be
+** pIn, whose content is then replaced.
+*/
+static void hashToBlob(const Blob *pIn, Blob *pCksum,
+                       const unsigned char *aHash, int nByte){
+  if( pIn==pCksum ){
+    blob_reset(pCksum);
+  }else{
+    blob_zero(pCksum);
+  }
+  if( blob_resize(pCksum, nByte*2) ) return;
+  encode16(aHash, (unsigned char*)blob_buffer(pCksum), nByte);
+}
+
+/*
+** Compute the SHA1 hash of the content of pIn and store it in pCksum
+** as 40 hexadecimal digits.  pCksum may be pIn.  Return 0.
+*/
+int sha1sum_blob(const Blob *pIn, Blob *pCksum){
+  unsigned char aHash[20];
+  sha1Hash((const unsigned char*)pIn->aData, pIn->nUsed, aHash);
+  hashToBlob(pIn, pCksum, aHash, 20);
+  return 0;
+}
+
+/*
+** Compute the SHA3 hash of iSize bits of the content of pIn and store
+** it in pCksum as iSize/4 hexadecimal digits.  iSize is 224, 256, 384
+** or 512.  pCksum may be pIn.
+*/
+void sha3sum_blob(const Blob *pIn, int iSize, Blob *pCksum){
+  unsigned char aHash[64];
+  assert( iSize==224 || iSize==256 || iSize==384 || iSize==512 );
+  sha3Hash((const unsigned char*)pIn->aData, pIn->nUsed, iSize, aHash);
+  hashToBlob(pIn, pCksum, aHash, iSize/8);
+}
+
+/*
+** Compute the hash of type iHType, one of the HNAME_ALG_* constants,
+** of the content of pContent and store it in pHashOut as hexadecimal.
+** Return 0, or 1 if iHType is unknown.
+*/
+int hname_hash(const Blob *pContent, unsigned int iHType, Blob *pHashOut){
+  switch( iHType ){
+    case HNAME_ALG_SHA1:
+      sha1sum_blob(pContent, pHashOut);
+      return 0;
+    case HNAME_ALG_K256:
+      sha3sum_blob(pContent, 256, pHashOut);
+      return 0;
+  }
+  return 1;
+}
+
+/*
+** State shared by the threads of one hname_hash_batch() call
+*/
+typedef struct HashBatch HashBatch;
+struct HashBatch {
+  Blob **apIn;                   /* Content to hash */
+  Blob *aOut;                    /* Hashes */
+  int n;                         /* Number of entries */
+  int iNext;                     /* Next entry to claim */
+  unsigned int iHType;           /* HNAME_ALG_* */
+  int iCat;                      /* Accounting category of the caller */
+};
+
+/*
+** Body of each hashing thread: claim the next blob until none are left.
+** The hashes are counted in the accounting category of the caller.
+*/
+static void *hashBatchWorker(void *pArg){
+  HashBatch *p = (HashBatch*)pArg;
+  int i;
+  blob_account_category(p->iCat);
+  while( (i = __atomic_fetch_add(&p->iNext, 1, __ATOMIC_RELAXED))<p->n ){
+    hname_hash(p->apIn[i], p->iHType, &p->aOut[i]);
+  }
+  return 0;
+}
+
+/*
+** Store the hash of type iHType of each of the n blobs apIn[] in aOut[],
+** which must be reset, using up to nThread threads (HNAME_BATCH_THREADS
+** if nThread is 0 or less).  The calling thread takes part.  Return 0,
+** or 1 if iHType is unknown.
+*/
+int hname_hash_batch(Blob **apIn, Blob *aOut, int n, unsigned int iHType,
+                     int nThread){
+  HashBatch b;
+  pthread_t aThread[HNAME_BATCH_MAX_THREADS];
+  int i, nStarted = 0;
+  if( iHType!=HNAME_ALG_SHA1 && iHType!=HNAME_ALG_K256 ) return 1;
+  if( nThread<=0 ) nThread = HNAME_BATCH_THREADS;
+  if( nThread>HNAME_BATCH_MAX_THREADS ) nThread = HNAME_BATCH_MAX_THREADS;
+  if( nThread>n ) nThread = n;
+  b.apIn = apIn;
+  b.aOut = aOut;
+  b.n = n;
+  b.iNext = 0;
+  b.iHType = iHType;
+  b.iCat = blob_account_category(0);
+  blob_account_category(b.iCat);
+  for(i=1; i<nThread; i++){
+    if( pthread_create(&aThread[nStarted], 0, hashBatchWorker, &b) ) break;
+    nStarted++;
+  }
+  hashBatchWorker(&b);
+  for(i=0; i<nStarted; i++){
+    pthread_join(aThread[i], 0);
+  }
+  return 0;
+}
@@ -0,0 +1,63 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** Interned strings.  A pool keeps one copy of each distinct byte string
+** it is given, in arena memory, and returns the same pointer for equal
+** content.  Strings from one pool can be compared for equality by
+** pointer, and their length and hash are stored in front of them.  They
+** stay valid until blob_intern_free().  A pool is not safe for use by
+** several threads at once.
+*/
+
+#include "fslbase.h"
+
+/*
+** Initialize an empty pool.
+*/
+void blob_intern_init(BlobIntern *p){
+  blob_arena_init(&p->arena, 0);
+  blob_map_init(&p->map);
+}
+
+/*
+** Free every string of a pool and leave it empty.
+*/
+void blob_intern_free(BlobIntern *p){
+  blob_map_free(&p->map);
+  blob_arena_free(&p->arena);
+}
+
+/*
+** Return the copy in pool p of the n bytes at z, or of the whole
+** zero-terminated string if n is negative, adding it if needed.  The
+** copy is zero-terminated.
+*/
+const char *blob_intern(BlobIntern *p, const char *z, blob_ssize_t n){
+  BlobMapEntry *pE;
+  BlobInternHdr *pHdr;
+  char *zCopy;
+  int bNew;
+  if( n<0 ) n = (blob_ssize_t)strlen(z);
+  pE = blob_map_insert(&p->map, z, (blob_size_t)n, &bNew);
+  if( bNew ){
+    pHdr = blob_arena_alloc(&p->arena, sizeof(*pHdr) + n + 1);
+    pHdr->h = pE->h;
+    pHdr->n = (blob_size_t)n;
+    zCopy = (char*)(pHdr + 1);
+    if( n>0 ) memcpy(zCopy, z, n);
+    zCopy[n] = 0;
+    /* Same content, so the entry stays where it is */
+    pE->zKey = zCopy;
+  }
+  return pE->zKey;
+}
@@ -0,0 +1,325 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** A hash map from byte strings to pointers, with open addressing in the
+** manner of SwissTable.  Slots come in groups of 16, each with a control
+** byte that says whether the slot is empty, deleted or full, and for a
+** full slot holds 7 bits of the hash of its key.  A lookup compares the
+** 16 control bytes of a group at once and only looks at the keys whose
+** bits match, so it rarely touches more than one entry.
+**
+** The map does not copy keys.  A key must stay valid and unchanged for
+** as long as it is in the map.
+*/
+
+#include "fslbase.h"
+#include "simd.h"
+
+/*
+** Control byte values.  Full slots hold 0..127.
+*/
+#define MAP_EMPTY    0x80
+#define MAP_DELETED  0xfe
+
+#define MAP_GROUP    16        /* Slots in a group */
+
+/*
+** Bit i of the return value is set if aCtrl[i] of the group is c.
+*/
+static unsigned int mapMatch(const unsigned char *aCtrl, unsigned char c){
+#ifdef FSL_SSE2
+  __m128i g = _mm_loadu_si128((const __m128i*)aCtrl);
+  return (unsigned int)_mm_movemask_epi8(
+                          _mm_cmpeq_epi8(g, _mm_set1_epi8((char)c)));
+#else
+  unsigned int m = 0;
+  int i;
+  for(i=0; i<MAP_GROUP; i++){
+    if( aCtrl[i]==c ) m |= 1u<<i;
+  }
+  return m;
+#endif
+}
+
+/*
+** Bit i of the return value is set if slot i of the group is full.
+*/
+static unsigned int mapFull(const unsigned char *aCtrl){
+#ifdef FSL_SSE2
+  __m128i g = _mm_loadu_si128((const __m128i*)aCtrl);
+  return ~(unsigned int)_mm_movemask_epi8(g) & 0xffff;
+#else
+  unsigned int m = 0;
+  int i;
+  for(i=0; i<MAP_GROUP; i++){
+    if( (aCtrl[i] & 0x80)==0 ) m |= 1u<<i;
+  }
+  return m;
+#endif
+}
+
+/*
+** Read 8, 4 or up to 3 bytes as a number.
+*/
+static u64 mapRead64(const unsigned char *p){
+  u64 x;
+  memcpy(&x, p, 8);
+  return x;
+}
+static u64 mapRead32(const unsigned char *p){
+  unsigned int x;
+  memcpy(&x, p, 4);
+  return x;
+}
+
+/*
+** Multiply a by b and fold the high half of the product into the low.
+*/
+static u64 mapMix(u64 a, u64 b){
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 r = (unsigned __int128)a * b;
+  return (u64)r ^ (u64)(r>>64);
+#else
+  u64 r = (a ^ (a>>29)) * (b | 1);
+  return r ^ (r>>32);
+#endif
+}
+
+#define MAP_P0  0xa0761d6478bd642fULL
+#define MAP_P1  0xe7037ed1a0b428dbULL
+#define MAP_P2  0x8ebc6af09c88c6e3ULL
+
+/*
+** A fast hash of the n bytes at z, not meant to resist attacks.  It
+** folds 16 bytes per multiplication, as wyhash does.
+*/
+u64 blob_map_hash(const char *z, blob_size_t n){
+  const unsigned char *p = (const unsigned char*)z;
+  u64 h = (u64)n * MAP_P0, a, b;
+  blob_size_t i = n;
+  while( i>16 ){
+    h = mapMix(mapRead64(p) ^ MAP_P1, mapRead64(p+8) ^ h);
+    p += 16;
+    i -= 16;
+  }
+  if( i>=8 ){
+    a = mapRead64(p);
+    b = mapRead64(p+i-8);
+  }else if( i>=4 ){
+    a = mapRead32(p);
+    b = mapRead32(p+i-4);
+  }else if( i>0 ){
+    a = (u64)p[0]<<16 | (u64)p[i>>1]<<8 | p[i-1];
+    b = 0;
+  }else{
+    a = b = 0;
+  }
+  h = mapMix(a ^ MAP_P1, b ^ h);
+  return mapMix(h ^ MAP_P2, (u64)n ^ MAP_P1);
+}
+
+/*
+** Make the map empty with room for nSlot entries, a power of two and
+** at least MAP_GROUP.
+*/
+static void mapAlloc(BlobMap *p, u64 nSlot){
+  p->aCtrl = fossil_malloc( nSlot );
+  memset(p->aCtrl, MAP_EMPTY, nSlot);
+  p->aEntry = fossil_malloc( nSlot*sizeof(BlobMapEntry) );
+  p->nSlot = nSlot;
+  p->nUsed = 0;
+  p->nGrowth = nSlot - nSlot/8;
+}
+
+/*
+** Return the first empty or deleted slot on the probe sequence of hash h.
+*/
+static u64 mapFindFree(BlobMap *p, u64 h){
+  u64 mask = p->nSlot/MAP_GROUP - 1;
+  u64 g = (h>>7) & mask, step = 0;
+  unsigned int m;
+  for(;;){
+    unsigned char *aCtrl = p->aCtrl + g*MAP_GROUP;
+    m = mapMatch(aCtrl, MAP_EMPTY) | mapMatch(aCtrl, MAP_DELETED);
+    if( m ) return g*MAP_GROUP + __builtin_ctz(m);
+    step++;
+    g = (g + step) & mask;
+  }
+}
+
+/*
+** Move the entries of p to a table of nSlot slots.
+*/
+static void mapRehash(BlobMap *p, u64 nSlot){
+  BlobMap old = *p;
+  u64 i, j;
+  mapAlloc(p, nSlot);
+  for(i=0; i<old.nSlot; i++){
+    if( old.aCtrl[i] & 0x80 ) continue;
+    j = mapFindFree(p, old.aEntry[i].h);
+    p->aCtrl[j] = old.aCtrl[i];
+    p->aEntry[j] = old.aEntry[i];
+  }
+  p->nUsed = old.nUsed;
+  p->nGrowth -= old.nUsed;
+  fossil_free(old.aCtrl);
+  fossil_free(old.aEntry);
+}
+
+/*
+** Initialize an empty map.  No memory is allocated until the first
+** insert.
+*/
+void blob_map_init(BlobMap *p){
+  memset(p, 0, sizeof(*p));
+}
+
+/*
+** Free the memory of a map and leave it empty.  The keys and values
+** are not freed.
+*/
+void blob_map_free(BlobMap *p){
+  fossil_free(p->aCtrl);
+  fossil_free(p->aEntry);
+  blob_map_init(p);
+}
+
+/*
+** Make room for n entries without rehashing.
+*/
+void blob_map_reserve(BlobMap *p, u64 n){
+  u64 nSlot = MAP_GROUP;
+  while( nSlot - nSlot/8 < n ) nSlot *= 2;
+  if( nSlot<=p->nSlot ) return;
+  if( p->nSlot==0 ){
+    mapAlloc(p, nSlot);
+  }else{
+    mapRehash(p, nSlot);
+  }
+}
+
+/*
+** Return the entry of key zKey of nKey bytes, whose hash is h, or NULL.
+*/
+static BlobMapEntry *mapFind(BlobMap *p, const char *zKey, blob_size_t nKey,
+                             u64 h){
+  u64 mask = p->nSlot/MAP_GROUP - 1;
+  u64 g = (h>>7) & mask, step = 0;
+  unsigned char *aCtrl;
+  BlobMapEntry *pE;
+  unsigned int m;
+  if( p->nSlot==0 ) return 0;
+  for(;;){
+    aCtrl = p->aCtrl + g*MAP_GROUP;
+    m = mapMatch(aCtrl, (unsigned char)(h & 0x7f));
+    while( m ){
+      pE = &p->aEntry[g*MAP_GROUP + __builtin_ctz(m)];
+      if( pE->h==h && pE->nKey==nKey
+       && (nKey==0 || memcmp(pE->zKey, zKey, nKey)==0) ){
+        return pE;
+      }
+      m &= m-1;
+    }
+    if( mapMatch(aCtrl, MAP_EMPTY) ) return 0;
+    step++;
+    g = (g + step) & mask;
+  }
+}
+
+/*
+** Return the entry of key zKey of nKey bytes, or NULL if there is none.
+*/
+BlobMapEntry *blob_map_find(BlobMap *p, const char *zKey, blob_size_t nKey){
+  return mapFind(p, zKey, nKey, blob_map_hash(zKey, nKey));
+}
+
+/*
+** Return the entry of key zKey of nKey bytes, adding one with a NULL
+** pValue if there is none.  *pbNew, if not NULL, is set to 1 if the
+** entry was added and 0 if it was there.  The pointer is valid until the
+** next insert.
+*/
+BlobMapEntry *blob_map_insert(BlobMap *p, const char *zKey,
+                              blob_size_t nKey, int *pbNew){
+  u64 h = blob_map_hash(zKey, nKey), i;
+  BlobMapEntry *pE = mapFind(p, zKey, nKey, h);
+  if( pbNew ) *pbNew = pE==0;
+  if( pE ) return pE;
+  if( p->nSlot==0 ){
+    mapAlloc(p, MAP_GROUP);
+  }
+  i = mapFindFree(p, h);
+  if( p->aCtrl[i]==MAP_EMPTY && p->nGrowth==0 ){
+    /* Full of live or deleted entries: grow, or clear out the deleted */
+    mapRehash(p, p->nUsed*2 > p->nSlot - p->nSlot/8 ? p->nSlot*2 : p->nSlot);
+    i = mapFindFree(p, h);
+  }
+  if( p->aCtrl[i]==MAP_EMPTY ) p->nGrowth--;
+  p->aCtrl[i] = (unsigned char)(h & 0x7f);
+  pE = &p->aEntry[i];
+  pE->zKey = zKey;
+  pE->nKey = nKey;
+  pE->h = h;
+  pE->pValue = 0;
+  p->nUsed++;
+  return pE;
+}
+
+/*
+** Remove entry pE, found in map p.  Entries other than pE do not move,
+** so this may be used while iterating.
+*/
+void blob_map_erase_entry(BlobMap *p, BlobMapEntry *pE){
+  u64 i = (u64)(pE - p->aEntry);
+  unsigned char *aCtrl = p->aCtrl + (i & ~(u64)(MAP_GROUP-1));
+  /* A group with an empty slot ends every probe that reaches it, so the
+  ** slot can become empty again.  Otherwise probes must go on past it. */
+  if( mapMatch(aCtrl, MAP_EMPTY) ){
+    p->aCtrl[i] = MAP_EMPTY;
+    p->nGrowth++;
+  }else{
+    p->aCtrl[i] = MAP_DELETED;
+  }
+  p->nUsed--;
+}
+
+/*
+** Remove the entry of key zKey of nKey bytes.  Return 1 if there was
+** one, or 0.
+*/
+int blob_map_erase(BlobMap *p, const char *zKey, blob_size_t nKey){
+  BlobMapEntry *pE = blob_map_find(p, zKey, nKey);
+  if( pE==0 ) return 0;
+  blob_map_erase_entry(p, pE);
+  return 1;
+}
+
+/*
+** Return the entry that follows pE in the map, in no particular order,
+** or the first one if pE is NULL.  Return NULL after the last.
+*/
+BlobMapEntry *blob_map_next(BlobMap *p, BlobMapEntry *pE){
+  u64 i = pE ? (u64)(pE - p->aEntry) + 1 : 0;
+  unsigned int m;
+  u64 g;
+  if( i>=p->nSlot ) return 0;
+  g = i & ~(u64)(MAP_GROUP-1);
+  m = mapFull(p->aCtrl + g) >> (i - g) << (i - g);
+  for(;;){
+    if( m ) return &p->aEntry[g + __builtin_ctz(m)];
+    g += MAP_GROUP;
+    if( g>=p->nSlot ) break;
+    m = mapFull(p->aCtrl + g);
+  }
+  return 0;
+}
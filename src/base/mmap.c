@@ -0,0 +1,151 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** Blobs whose content is a private memory mapping of a file.  Reading
+** such a blob costs no copy, and the pages are shared with every other
+** process mapping the same file.  The first change made through the
+** blob interfaces copies the content into memory from malloc().
+*/
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "fslbase.h"
+
+/*
+** Return the start of the page that holds z.  The content of a mapped
+** blob starts there, unless blobMmapAdvance() has moved aData on.
+*/
+static char *mmapBase(char *z){
+  size_t szPage = (size_t)sysconf(_SC_PAGESIZE);
+  return (char*)((size_t)z & ~(szPage-1));
+}
+
+/*
+** Drop the first n bytes of the mapping of a mapped blob by advancing
+** aData, so that the mapping is never written.  Pages left wholly behind
+** are unmapped.  Used by blob_compact().
+*/
+void blobMmapAdvance(Blob *pBlob, blob_size_t n){
+  char *pBase = mmapBase(pBlob->aData);
+  char *pNewBase;
+  pBlob->aData += n;
+  pBlob->nAlloc -= n;
+  pNewBase = mmapBase(pBlob->aData);
+  if( pNewBase>pBase ) munmap(pBase, pNewBase - pBase);
+}
+
+/*
+** A reallocation function for blobs whose aData is a mapping made by
+** blob_init_mmap().
+**
+** A newSize of 0 unmaps the file.  Any other size copies the content to
+** memory from blobReallocMalloc(), where it is counted, and turns the
+** blob into an ordinary one.  If a memory budget refuses the copy the
+** blob keeps its mapping and BLOBFLAG_OverBudget is set.
+*/
+void blobReallocMmap(Blob *pBlob, blob_size_t newSize){
+  char *pBase = mmapBase(pBlob->aData);
+  Blob b = empty_blob;
+  if( newSize>0 ){
+    blobReallocMalloc(&b, newSize);
+    if( b.blobFlags & BLOBFLAG_OverBudget ){
+      pBlob->blobFlags |= BLOBFLAG_OverBudget;
+      return;
+    }
+    if( pBlob->nUsed>newSize ) pBlob->nUsed = newSize;
+    memcpy(b.aData, pBlob->aData, pBlob->nUsed);
+    b.nUsed = pBlob->nUsed;
+    b.iCursor = pBlob->iCursor;
+    b.blobFlags |= pBlob->blobFlags & BLOBFLAG_NotSQL;
+  }
+  munmap(pBase, pBlob->aData + pBlob->nAlloc - pBase);
+  *pBlob = b;
+}
+
+/*
+** Give the kernel a hint about how the content of a mapped blob is
+** going to be read.  eAdvice is one of the BLOB_MMAP_* constants.
+** This is a no-op for blobs that are not (or no longer) mapped.
+*/
+void blob_mmap_advise(Blob *pBlob, int eAdvice){
+  char *pBase;
+  int advice;
+  if( pBlob->xRealloc!=blobReallocMmap ) return;
+  switch( eAdvice ){
+    case BLOB_MMAP_SEQUENTIAL: advice = MADV_SEQUENTIAL;  break;
+    case BLOB_MMAP_RANDOM:     advice = MADV_RANDOM;      break;
+    case BLOB_MMAP_WILLNEED:   advice = MADV_WILLNEED;    break;
+    default:                   advice = MADV_NORMAL;      break;
+  }
+  pBase = mmapBase(pBlob->aData);
+  madvise(pBase, pBlob->aData + pBlob->nAlloc - pBase, advice);
+}
+
+/*
+** Initialize a blob to a private read-only view of the file open on
+** descriptor fd.  The descriptor may be closed afterwards.  Any prior
+** content of the blob is discarded, not freed.
+**
+** Return the size of the blob, or -1 on error, with errno set to EFBIG
+** for a file too large for a blob.  An empty file gives an empty
+** (unmapped) blob.
+*/
+blob_ssize_t blob_init_mmap(Blob *pBlob, int fd, int eAdvice){
+  struct stat st;
+  long szPage = sysconf(_SC_PAGESIZE);
+  size_t nMap;
+  void *p;
+  blob_zero(pBlob);
+  if( fstat(fd, &st)!=0 ) return -1;
+  if( st.st_size==0 ) return 0;
+  /* The content and the nul terminator must fit in a blob */
+  if( (u64)st.st_size>=(u64)MAX_BLOB_SIZE-1 ){
+    errno = EFBIG;
+    return -1;
+  }
+  /*
+  ** The mapping is writable so that the nul terminator blob_str() stores
+  ** after the content lands in the zero-filled tail of the last page.
+  ** Being private, the write only copies that one page.  There is no
+  ** such tail when the file is a whole number of pages.
+  */
+  nMap = (size_t)st.st_size;
+  p = mmap(0, nMap, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+  if( p==MAP_FAILED ) return -1;
+  pBlob->aData = p;
+  pBlob->nUsed = (blob_size_t)nMap;
+  pBlob->nAlloc = nMap % szPage ? pBlob->nUsed + 1 : pBlob->nUsed;
+  pBlob->xRealloc = blobReallocMmap;
+  blob_mmap_advise(pBlob, eAdvice);
+  return blob_size(pBlob);
+}
+
+/*
+** Initialize a blob to a private read-only view of the file named
+** zFilename.  Return the size of the blob, or -1 on error.
+*/
+blob_ssize_t blob_read_mmap(Blob *pBlob, const char *zFilename, int eAdvice){
+  blob_ssize_t n;
+  int fd = open(zFilename, O_RDONLY);
+  if( fd<0 ){
+    blob_zero(pBlob);
+    return -1;
+  }
+  n = blob_init_mmap(pBlob, fd, eAdvice);
+  close(fd);
+  return n;
+}
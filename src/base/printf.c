@@ -240,6 +240,82 @@ static int et_getdigit(long double *val, int *cnt){
   return digit;
 }
 
+/*
+** libfsl: the digit pairs "00" through "99", for converting integers to
+** base 10 two digits at a time.
+*/
+static const char aDigitPair[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233"
+  "34353637383940414243444546474849505152535455565758596061626364656667"
+  "6869707172737475767778798081828384858687888990919293949596979899";
+
+/*
+** libfsl: return the number of decimal digits in v.  The bit length
+** times log10(2), which 1233/4096 approximates, is the count or one
+** less than it.
+*/
+static int et_decimal_len(u64 v){
+  static const u64 aPow10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL
+  };
+  int n;
+  v |= 1;
+  n = ((64 - __builtin_clzll(v)) * 1233) >> 12;
+  return n + (v>=aPow10[n]);
+}
+
+/*
+** libfsl: write v in base 10 so that it ends just before zEnd.  Return
+** the number of digits.  Values below 2**32 use 32-bit divisions.
+*/
+static int et_radix10(char *zEnd, u64 v){
+  int n = et_decimal_len(v);
+  char *z = zEnd;
+  unsigned int w;
+  while( v>0xffffffff ){
+    const char *d = &aDigitPair[(v%100)*2];
+    v /= 100;
+    *(--z) = d[1];
+    *(--z) = d[0];
+  }
+  w = (unsigned int)v;
+  while( w>=100 ){
+    const char *d = &aDigitPair[(w%100)*2];
+    w /= 100;
+    *(--z) = d[1];
+    *(--z) = d[0];
+  }
+  if( w>=10 ){
+    *(--z) = aDigitPair[w*2+1];
+    *(--z) = aDigitPair[w*2];
+  }else{
+    *(--z) = (char)('0' + w);
+  }
+  assert( zEnd-z==n );
+  return n;
+}
+
+/*
+** libfsl: write v in base 2**nBit using the digits cset[] so that it ends
+** just before zEnd.  Return the number of digits.
+*/
+static int et_radix_pow2(char *zEnd, u64 v, int nBit, const char *cset){
+  int n = (64 - __builtin_clzll(v|1) + nBit - 1)/nBit;
+  unsigned int mask = (1u<<nBit) - 1;
+  char *z = zEnd;
+  do{
+    *(--z) = cset[v & mask];
+    v >>= nBit;
+  }while( v );
+  assert( zEnd-z==n );
+  return n;
+}
+
 /*
 ** Size of temporary conversion buffer.
 */
@@ -300,6 +376,221 @@ void fossil_puts(const char *z, int toStdErr, int n){
 #endif
 }
 
+/*
+** libfsl: a conversion specification as parsed from a format string.
+** The width and the precision are FMT_STAR when they come from the
+** argument list.
+*/
+typedef struct FmtSpec FmtSpec;
+struct FmtSpec {
+  int width;                 /* Field width, or FMT_STAR */
+  int precision;             /* Precision, -1 if none, or FMT_STAR */
+  etByte flags;              /* One or more of the FMT_ constants below */
+  etByte cThousand;          /* Thousands separator or 0 */
+  etByte nLong;              /* 1 for "l", 2 for "ll" */
+  etByte iInfo;              /* Index into fmtinfo[], or FMT_UNKNOWN */
+  char c;                    /* The conversion character */
+};
+
+#define FMT_STAR        (-2)
+#define FMT_UNKNOWN     0xff
+#define FMT_LEFT        0x01     /* "-" */
+#define FMT_PLUS        0x02     /* "+" */
+#define FMT_BLANK       0x04     /* " " */
+#define FMT_ALT         0x08     /* "#" */
+#define FMT_ALT2        0x10     /* "!" */
+#define FMT_ZEROPAD     0x20     /* "0" */
+
+/*
+** Parse the conversion specification that begins at fmt, the byte
+** after the '%', into *p.  Return a pointer to the conversion
+** character, which is the terminating 0x00 of a truncated
+** specification.
+*/
+static const char *fmtParse(const char *fmt, FmtSpec *p){
+  int c = *fmt;
+  const char *zFmtLookup;
+  etByte done = 0;
+
+  p->flags = p->cThousand = 0;
+  do{
+    switch( c ){
+      case '-':   p->flags |= FMT_LEFT;     break;
+      case '+':   p->flags |= FMT_PLUS;     break;
+      case ' ':   p->flags |= FMT_BLANK;    break;
+      case '#':   p->flags |= FMT_ALT;      break;
+      case '!':   p->flags |= FMT_ALT2;     break;
+      case '0':   p->flags |= FMT_ZEROPAD;  break;
+      case ',':   p->cThousand = ',';       break;
+      default:    done = 1;                 break;
+    }
+  }while( !done && (c=(*++fmt))!=0 );
+  p->width = 0;
+  if( c=='*' ){
+    p->width = FMT_STAR;
+    c = *++fmt;
+  }else{
+    while( c>='0' && c<='9' ){
+      if( p->width<=etBUFSIZE ) p->width = p->width*10 + c - '0';
+      c = *++fmt;
+    }
+    if( p->width > etBUFSIZE-10 ) p->width = etBUFSIZE-10;
+  }
+  p->precision = -1;
+  if( c=='.' ){
+    p->precision = 0;
+    c = *++fmt;
+    if( c=='*' ){
+      p->precision = FMT_STAR;
+      c = *++fmt;
+    }else{
+      while( c>='0' && c<='9' ){
+        if( p->precision<0x7fffff ) p->precision = p->precision*10 + c - '0';
+        c = *++fmt;
+      }
+    }
+  }
+  p->nLong = 0;
+  if( c=='l' ){
+    p->nLong = 1;
+    c = *++fmt;
+    if( c=='l' ){
+      p->nLong = 2;
+      c = *++fmt;
+    }
+  }
+  zFmtLookup = strchr(fmtchr,c);
+  p->iInfo = zFmtLookup ? (etByte)(zFmtLookup-fmtchr) : FMT_UNKNOWN;
+  p->c = (char)c;
+  return fmt;
+}
+
+/*
+** libfsl: a compiled format string.  Each op is a run of literal text
+** followed by one conversion, and the text after the last conversion
+** is the tail.  The offsets are into zFmt, a private copy of the
+** format string.  A format that cannot be compiled keeps nOp at -1,
+** so that it is not compiled again.
+*/
+typedef struct FmtOp FmtOp;
+struct FmtOp {
+  int iLit, nLit;            /* Literal text ahead of the conversion */
+  FmtSpec spec;              /* The conversion */
+};
+typedef struct FmtProg FmtProg;
+struct FmtProg {
+  const char *zKey;          /* Format string this was compiled from */
+  char *zFmt;                /* Private copy of the format string */
+  int iTail, nTail;          /* Literal text after the last conversion */
+  int nOp;                   /* Number of entries in aOp[], or -1 */
+  FmtOp aOp[1];              /* One op per conversion */
+};
+
+/*
+** Compiled formats are found by the address of the format string in an
+** open addressing table that only ever grows, so that the readers need
+** no locks.  The text is compared on each hit as well, which keeps a
+** format built in a reused buffer from picking up a stale program.
+*/
+#define FMT_CACHE_SIZE   512     /* Slots in the table, a power of two */
+#define FMT_CACHE_PROBE  8       /* Slots looked at for one format */
+#define FMT_MAX_LEN      2000    /* Longer formats are never compiled */
+
+static FmtProg *aFmtCache[FMT_CACHE_SIZE];
+static int fmtCacheOn = 0;
+
+/*
+** Compile the format string zFmt of nFmt bytes.
+*/
+static FmtProg *fmtCompile(const char *zFmt, int nFmt){
+  FmtProg *p;
+  FmtSpec spec;
+  const char *z;
+  int nPct = 0;
+  int i;
+
+  for(i=0; i<nFmt; i++){
+    if( zFmt[i]=='%' ) nPct++;
+  }
+  p = fossil_malloc(sizeof(*p) + nPct*sizeof(FmtOp) + nFmt + 1);
+  p->zKey = zFmt;
+  p->zFmt = (char*)&p->aOp[nPct+1];
+  memcpy(p->zFmt, zFmt, nFmt+1);
+  p->nOp = 0;
+  for(i=0; (z = strchr(p->zFmt+i, '%'))!=0; i=(int)(z-p->zFmt)+1){
+    FmtOp *pOp = &p->aOp[p->nOp];
+    pOp->iLit = i;
+    pOp->nLit = (int)(z-p->zFmt) - i;
+    if( z[1]==0 ) break;
+    z = fmtParse(z+1, &spec);
+    if( spec.iInfo==FMT_UNKNOWN || spec.c==0 ) break;
+    pOp->spec = spec;
+    p->nOp++;
+  }
+  if( z ){
+    /* Errors are left to the interpreter of vxprintf() */
+    p->nOp = -1;
+  }else{
+    p->iTail = i;
+    p->nTail = nFmt - i;
+  }
+  return p;
+}
+
+/*
+** Return the compiled form of zFmt, or NULL if it is to be interpreted.
+*/
+static FmtProg *fmtLookup(const char *zFmt){
+  unsigned h = (unsigned)(((u64)(size_t)zFmt * 0x9e3779b97f4a7c15ULL) >> 40);
+  FmtProg *pNew = 0;
+  int nFmt = -1;
+  int i;
+
+  for(i=0; i<FMT_CACHE_PROBE; i++){
+    FmtProg **pp = &aFmtCache[(h+i) & (FMT_CACHE_SIZE-1)];
+    FmtProg *p = __atomic_load_n(pp, __ATOMIC_ACQUIRE);
+    if( p==0 ){
+      if( pNew==0 ){
+        nFmt = (int)strlen(zFmt);
+        if( nFmt>FMT_MAX_LEN ) return 0;
+        pNew = fmtCompile(zFmt, nFmt);
+      }
+      if( __atomic_compare_exchange_n(pp, &p, pNew, 0,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ){
+        return pNew->nOp<0 ? 0 : pNew;
+      }
+      /* Another thread took the slot.  p is what it stored. */
+    }
+    if( p->zKey==zFmt && strcmp(p->zFmt, zFmt)==0 ){
+      fossil_free(pNew);
+      return p->nOp<0 ? 0 : p;
+    }
+  }
+  fossil_free(pNew);
+  return 0;
+}
+
+/*
+** Turn the cache of compiled format strings on or off.  It is off by
+** default.  Formats stay compiled for the life of the process, whatever
+** the setting, since other threads may be using them.
+*/
+void vxprintf_cache_enable(int bEnable){
+  __atomic_store_n(&fmtCacheOn, bEnable!=0, __ATOMIC_RELAXED);
+}
+
+/*
+** Return the number of format strings in the cache.
+*/
+int vxprintf_cache_count(void){
+  int i, n = 0;
+  for(i=0; i<FMT_CACHE_SIZE; i++){
+    FmtProg *p = __atomic_load_n(&aFmtCache[i], __ATOMIC_ACQUIRE);
+    if( p && p->nOp>=0 ) n++;
+  }
+  return n;
+}
+
 /*
 ** The root program.  All variations call this core.
 **
@@ -319,7 +610,7 @@ void fossil_puts(const char *z, int toStdErr, int n){
 ** seems to make a big difference in determining how fast this beast
 ** will run.
 */
-int vxprintf(
+blob_ssize_t vxprintf(
   Blob *pBlob,                       /* Append output to this blob */
   const char *fmt,                   /* Format string */
   va_list ap                         /* arguments */
@@ -327,9 +618,9 @@ int vxprintf(
   int c;                     /* Next character in the format string */
   char *bufpt;               /* Pointer to the conversion buffer */
   int precision;             /* Precision of the current field */
-  int length;                /* Length of the field */
+  blob_ssize_t length;       /* Length of the field */
   int idx;                   /* A general purpose loop counter */
-  int count;                 /* Total number of characters output */
+  blob_ssize_t count;        /* Total number of characters output */
   int width;                 /* Width of the current field */
   etByte flag_leftjustify;   /* True if "-" flag is present */
   etByte flag_plussign;      /* True if "+" flag is present */
@@ -339,7 +630,6 @@ int vxprintf(
   etByte flag_zeropad;       /* True if field width constant starts with zero */
   etByte flag_long;          /* True if "l" flag is present */
   etByte flag_longlong;      /* True if the "ll" flag is present */
-  etByte done;               /* Loop termination flag */
   etByte cThousand;          /* Thousands separator for %d and %u */
   u64 longvalue;             /* Value for integer types */
   long double realvalue;     /* Value for real types */
@@ -358,95 +648,81 @@ int vxprintf(
   etByte flag_rtz;           /* True if trailing zeros should be removed */
   etByte flag_exp;           /* True to force display of the exponent */
   int nsd;                   /* Number of significant digits returned */
-  char *zFmtLookup;
+  FmtSpec spec;               /* libfsl: the specification being interpreted */
+  const FmtSpec *pSpec;      /* libfsl: the current conversion */
+  FmtProg *pProg = 0;        /* libfsl: compiled form of fmt, if any */
+  int iOp = 0;               /* libfsl: next op of pProg */
 
   count = length = 0;
   bufpt = 0;
-  for(; (c=(*fmt))!=0; ++fmt){
-    if( c!='%' ){
-      bufpt = (char *)fmt;
+  if( __atomic_load_n(&fmtCacheOn, __ATOMIC_RELAXED) ){
+    pProg = fmtLookup(fmt);
+  }
+  for(;;){
+    if( pProg ){
+      /* libfsl: the next conversion is taken from the compiled form */
+      const FmtOp *pOp;
+      if( iOp==pProg->nOp ){
+        blob_append(pBlob, pProg->zFmt+pProg->iTail, pProg->nTail);
+        break;
+      }
+      pOp = &pProg->aOp[iOp++];
+      if( pOp->nLit ) blob_append(pBlob, pProg->zFmt+pOp->iLit, pOp->nLit);
+      pSpec = &pOp->spec;
+    }else{
+      if( (c=(*fmt))==0 ) break;
+      if( c!='%' ){
+        bufpt = (char *)fmt;
 #if HAVE_STRCHRNUL
-      fmt = strchrnul(fmt, '%');
+        fmt = strchrnul(fmt, '%');
 #else
-      do{ fmt++; }while( *fmt && *fmt != '%' );
+        do{ fmt++; }while( *fmt && *fmt != '%' );
 #endif
-      blob_append(pBlob, bufpt, (int)(fmt - bufpt));
-      if( *fmt==0 ) break;
-    }
-    if( (c=(*++fmt))==0 ){
-      errorflag = 1;
-      blob_append(pBlob,"%",1);
-      count++;
-      break;
+        blob_append(pBlob, bufpt, (int)(fmt - bufpt));
+        if( *fmt==0 ) break;
+      }
+      if( (c=(*++fmt))==0 ){
+        errorflag = 1;
+        blob_append(pBlob,"%",1);
+        count++;
+        break;
+      }
+      fmt = fmtParse(fmt, &spec);
+      pSpec = &spec;
     }
     /* Find out what flags are present */
-    flag_leftjustify = flag_plussign = flag_blanksign = cThousand =
-     flag_alternateform = flag_altform2 = flag_zeropad = 0;
-    done = 0;
-    do{
-      switch( c ){
-        case '-':   flag_leftjustify = 1;     break;
-        case '+':   flag_plussign = 1;        break;
-        case ' ':   flag_blanksign = 1;       break;
-        case '#':   flag_alternateform = 1;   break;
-        case '!':   flag_altform2 = 1;        break;
-        case '0':   flag_zeropad = 1;         break;
-        case ',':   cThousand = ',';          break;
-        default:    done = 1;                 break;
-      }
-    }while( !done && (c=(*++fmt))!=0 );
+    flag_leftjustify = (pSpec->flags & FMT_LEFT)!=0;
+    flag_plussign = (pSpec->flags & FMT_PLUS)!=0;
+    flag_blanksign = (pSpec->flags & FMT_BLANK)!=0;
+    flag_alternateform = (pSpec->flags & FMT_ALT)!=0;
+    flag_altform2 = (pSpec->flags & FMT_ALT2)!=0;
+    flag_zeropad = (pSpec->flags & FMT_ZEROPAD)!=0;
+    cThousand = pSpec->cThousand;
     /* Get the field width */
-    width = 0;
-    if( c=='*' ){
+    width = pSpec->width;
+    if( width==FMT_STAR ){
       width = va_arg(ap,int);
       if( width<0 ){
         flag_leftjustify = 1;
         width = -width;
       }
-      c = *++fmt;
-    }else{
-      while( c>='0' && c<='9' ){
-        width = width*10 + c - '0';
-        c = *++fmt;
+      if( width > etBUFSIZE-10 ){
+        width = etBUFSIZE-10;
       }
     }
-    if( width > etBUFSIZE-10 ){
-      width = etBUFSIZE-10;
-    }
     /* Get the precision */
-    if( c=='.' ){
-      precision = 0;
-      c = *++fmt;
-      if( c=='*' ){
-        precision = va_arg(ap,int);
-        if( precision<0 ) precision = -precision;
-        c = *++fmt;
-      }else{
-        while( c>='0' && c<='9' ){
-          precision = precision*10 + c - '0';
-          c = *++fmt;
-        }
-      }
-    }else{
-      precision = -1;
+    precision = pSpec->precision;
+    if( precision==FMT_STAR ){
+      precision = va_arg(ap,int);
+      if( precision<0 ) precision = -precision;
     }
     /* Get the conversion type modifier */
-    if( c=='l' ){
-      flag_long = 1;
-      c = *++fmt;
-      if( c=='l' ){
-        flag_longlong = 1;
-        c = *++fmt;
-      }else{
-        flag_longlong = 0;
-      }
-    }else{
-      flag_long = flag_longlong = 0;
-    }
+    flag_long = pSpec->nLong>0;
+    flag_longlong = pSpec->nLong>1;
     /* Fetch the info entry for the field */
-    zFmtLookup = strchr(fmtchr,c);
-    if( zFmtLookup ){
-      infop = &fmtinfo[zFmtLookup-fmtchr];
+    c = pSpec->c;
+    if( pSpec->iInfo!=FMT_UNKNOWN ){
+      infop = &fmtinfo[pSpec->iInfo];
       xtype = infop->type;
     }else{
       infop = 0;
@@ -492,7 +768,7 @@ int vxprintf(
           else if( flag_long )  v = va_arg(ap,long int);
           else                  v = va_arg(ap,int);
           if( v<0 ){
-            longvalue = -v;
+            longvalue = -(u64)v;  /* libfsl: no overflow at the minimum */
             prefix = '-';
           }else{
             longvalue = v;
@@ -511,17 +787,35 @@ int vxprintf(
           precision = width-(prefix!=0);
         }
         bufpt = &buf[etBUFSIZE-1];
-        {
-          register const char *cset;      /* Use registers for speed */
-          register int base;
-          cset = &aDigits[infop->charset];
-          base = infop->base;
-          do{                                           /* Convert to ascii */
-            *(--bufpt) = cset[longvalue%base];
-            longvalue = longvalue/base;
-          }while( longvalue>0 );
+        /* libfsl: no division by a variable base for the usual bases */
+        switch( infop->base ){
+          case 10:
+            length = et_radix10(bufpt, longvalue);
+            bufpt -= length;
+            break;
+          case 16:
+            length = et_radix_pow2(bufpt, longvalue, 4,
+                                   &aDigits[infop->charset]);
+            bufpt -= length;
+            break;
+          case 8:
+            length = et_radix_pow2(bufpt, longvalue, 3,
+                                   &aDigits[infop->charset]);
+            bufpt -= length;
+            break;
+          default: {
+            register const char *cset;      /* Use registers for speed */
+            register int base;
+            cset = &aDigits[infop->charset];
+            base = infop->base;
+            do{                                         /* Convert to ascii */
+              *(--bufpt) = cset[longvalue%base];
+              longvalue = longvalue/base;
+            }while( longvalue>0 );
+            length = &buf[etBUFSIZE-1]-bufpt;
+            break;
+          }
         }
-        length = &buf[etBUFSIZE-1]-bufpt;
         while( precision>length ){
           *(--bufpt) = '0';                             /* Zero pad */
           length++;
@@ -690,7 +984,7 @@ int vxprintf(
         }
         break;
       case etSIZE:
-        *(va_arg(ap,int*)) = count;
+        *(va_arg(ap,int*)) = (int)count;
         length = width = 0;
         break;
       case etPERCENT:
@@ -762,7 +1056,7 @@ int vxprintf(
         int limit = flag_alternateform ? va_arg(ap, int) : -1;
         Blob *pBlob = va_arg(ap, Blob*);
         char *zOrig = blob_buffer(pBlob);
-        int i, j, n, cnt;
+        blob_ssize_t i, j, n, cnt;
         n = blob_size(pBlob);
         if( limit>=0 && limit<n ) n = limit;
         for(cnt=i=0; i<n; i++){ if( zOrig[i]=='\'' ) cnt++; }
@@ -881,18 +1175,38 @@ int vxprintf(
         length = width = 0;
         break;
       }
+#endif /* libfsl */
       case etHEX: {
+        int limit = flag_alternateform ? va_arg(ap,int) : -1;
         char *zArg = va_arg(ap, char*);
-        int szArg = (int)strlen(zArg);
+        blob_ssize_t szArg;
+        if( zArg==0 ) zArg = "";
+        szArg = limit>=0 ? limit : (blob_ssize_t)strlen(zArg);
+#if 0 /* libfsl */
         int szBlob = blob_size(pBlob);
         u8 *aBuf;
         blob_resize(pBlob, szBlob+szArg*2+1);
         aBuf = (u8*)&blob_buffer(pBlob)[szBlob];
         encode16((const u8*)zArg, aBuf, szArg);
         length = width = 0;
+#else
+        /* libfsl: %#H takes a length, output is counted and padded */
+        if( pBlob && width<=2*szArg ){
+          blob_encode16(pBlob, zArg, szArg);
+          count += 2*szArg;
+          length = width = 0;
+          break;
+        }
+        if( 2*szArg+1 > etBUFSIZE ){
+          bufpt = zExtra = fossil_malloc( 2*szArg + 1 );
+        }else{
+          bufpt = buf;
+        }
+        encode16((const unsigned char*)zArg, (unsigned char*)bufpt, szArg);
+        length = 2*szArg;
+#endif /* libfsl */
         break;
       }
-#endif /* libfsl */
       case etERROR:
         buf[0] = '%';
         buf[1] = c;
@@ -909,7 +1223,7 @@ int vxprintf(
     ** the output.
     */
     if( !flag_leftjustify ){
-      register int nspace;
+      register blob_ssize_t nspace;
       nspace = width-length;
       if( nspace>0 ){
         count += nspace;
@@ -925,7 +1239,7 @@ int vxprintf(
       count += length;
     }
     if( flag_leftjustify ){
-      register int nspace;
+      register blob_ssize_t nspace;
       nspace = width-length;
       if( nspace>0 ){
         count += nspace;
@@ -939,6 +1253,7 @@ int vxprintf(
     if( zExtra ){
       fossil_free(zExtra);
     }
+    if( pProg==0 ) ++fmt;
   }/* End for loop over the format string */
   return errorflag ? -1 : count;
 } /* End of function */
@@ -961,7 +1276,10 @@ char *mprintf(const char *zFormat, ...){
 char *vmprintf(const char *zFormat, va_list ap){
   Blob blob = empty_blob;
   blob_vappendf(&blob, zFormat, ap);
-  blob_materialize(&blob);
+  if( blob_materialize(&blob)!=blob.aData ){
+    /* libfsl: a memory budget refused even the terminator */
+    return memset(fossil_malloc(1), 0, 1);
+  }
   return blob.aData;
 }
 
@@ -0,0 +1,304 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** Byte scanners used to split text into lines and tokens.  Whitespace
+** is what fossil_isspace() says it is: ' ' and '\t' through '\r'.
+** Each scanner has SSE2 and AVX2 versions and a portable fallback.
+** Newlines are found with memchr(), which the C library vectorizes.
+**
+** Substring search over a Blob uses the SIMD filter of Wojciech Mula:
+** a block of candidate positions is kept only where both the first and
+** the last byte of the needle match, and only those are memcmp()ed.
+** Needles longer than FIND_MAX_FILTER go to memmem(), whose two-way
+** search stays linear however repetitive the input is.
+*/
+
+#define _GNU_SOURCE     /* memmem() on glibc */
+
+#include "fslbase.h"
+#include "simd.h"
+
+/*
+** Longest needle searched with the first/last byte filter
+*/
+#define FIND_MAX_FILTER  64
+
+/*
+** Return the offset of the first byte c in z[0..n-1], or n if there is
+** none.
+*/
+static blob_size_t scanChar(const char *z, blob_size_t n, char c){
+  const char *p = memchr(z, c, n);
+  return p ? (blob_size_t)(p - z) : n;
+}
+
+/*
+** Return the offset of the first '\n' in z[0..n-1], or n if there is
+** none.
+*/
+blob_size_t scan_newline(const char *z, blob_size_t n){
+  return scanChar(z, n, '\n');
+}
+
+#ifdef FSL_SSE2
+/*
+** Bytes of v that are whitespace are set to 0xff, all others to 0.
+** '\t'..'\r' are the bytes whose distance from '\t' is at most 4.
+*/
+static __m128i scanSpace16(__m128i v){
+  __m128i sp = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+  __m128i t = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+  __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(4)), t);
+  return _mm_or_si128(sp, ctl);
+}
+#endif
+
+#ifdef FSL_AVX2
+FSL_TARGET_AVX2
+static __m256i scanSpace32(__m256i v){
+  __m256i sp = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+  __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+  __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(4)), t);
+  return _mm256_or_si256(sp, ctl);
+}
+
+/*
+** AVX2 body of scan_space() (isSpace==1) and scan_nonspace()
+** (isSpace==0).  Return the offset of the first match among the whole
+** 32-byte blocks of z[0..n-1], or the offset where the blocks end.
+*/
+FSL_TARGET_AVX2
+static blob_size_t scanAvx2(const char *z, blob_size_t n, int isSpace){
+  blob_size_t i;
+  unsigned int m;
+  for(i=0; i+32<=n; i+=32){
+    m = _mm256_movemask_epi8(scanSpace32(_mm256_loadu_si256((void*)(z+i))));
+    if( !isSpace ) m = ~m;
+    if( m ) return i + __builtin_ctz(m);
+  }
+  return i;
+}
+#endif
+
+/*
+** Common body of scan_space() and scan_nonspace()
+*/
+static blob_size_t scanClass(const char *z, blob_size_t n, int isSpace){
+  blob_size_t i = 0;
+#ifdef FSL_AVX2
+  if( n>=32 && fsl_cpu_avx2() ){
+    i = scanAvx2(z, n, isSpace);
+    if( i+32<=n ) return i;
+  }
+#endif
+#ifdef FSL_SSE2
+  for(; i+16<=n; i+=16){
+    unsigned int m;
+    m = _mm_movemask_epi8(scanSpace16(_mm_loadu_si128((void*)(z+i))));
+    if( !isSpace ) m = ~m & 0xffff;
+    if( m ) return i + __builtin_ctz(m);
+  }
+#endif
+  while( i<n && fossil_isspace(z[i])!=isSpace ){ i++; }
+  return i;
+}
+
+/*
+** Return the offset of the first whitespace byte in z[0..n-1], or n if
+** there is none.
+*/
+blob_size_t scan_space(const char *z, blob_size_t n){
+  return scanClass(z, n, 1);
+}
+
+/*
+** Return the offset of the first byte in z[0..n-1] that is not
+** whitespace, or n if there is none.
+*/
+blob_size_t scan_nonspace(const char *z, blob_size_t n){
+  return scanClass(z, n, 0);
+}
+
+/*
+** True if the n-byte needle z matches at a, given that the first and
+** last bytes are already known to match.
+*/
+#define findMatch(a,z,n)  ((n)<3 || memcmp((a)+1, (z)+1, (n)-2)==0)
+
+#ifdef FSL_AVX2
+/*
+** AVX2 body of scan_find().  Return the offset of the first match among
+** the whole 32-position blocks of z[0..n-1], or the offset of the first
+** position not covered by a block if there is none.  *pFound is set to
+** 1 on a match.
+*/
+FSL_TARGET_AVX2
+static blob_size_t findFirstAvx2(
+  const char *z, blob_size_t n,
+  const char *zNeedle, blob_size_t m,
+  int *pFound
+){
+  __m256i vF = _mm256_set1_epi8(zNeedle[0]);
+  __m256i vL = _mm256_set1_epi8(zNeedle[m-1]);
+  blob_size_t i;
+  unsigned int mask;
+  for(i=0; i+32<=n-m+1; i+=32){
+    __m256i a = _mm256_loadu_si256((void*)(z+i));
+    __m256i b = _mm256_loadu_si256((void*)(z+i+m-1));
+    mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, vF),
+                                                 _mm256_cmpeq_epi8(b, vL)));
+    while( mask ){
+      blob_size_t j = i + __builtin_ctz(mask);
+      if( findMatch(z+j, zNeedle, m) ){
+        *pFound = 1;
+        return j;
+      }
+      mask &= mask-1;
+    }
+  }
+  return i;
+}
+
+/*
+** AVX2 body of scan_find_last().  Search the positions below iEnd, 32 at a
+** time from the top, and return the offset of the last match, or the
+** lowest position not covered by a block.  *pFound is set on a match.
+*/
+FSL_TARGET_AVX2
+static blob_size_t findLastAvx2(
+  const char *z, blob_size_t iEnd,
+  const char *zNeedle, blob_size_t m,
+  int *pFound
+){
+  __m256i vF = _mm256_set1_epi8(zNeedle[0]);
+  __m256i vL = _mm256_set1_epi8(zNeedle[m-1]);
+  unsigned int mask;
+  while( iEnd>=32 ){
+    blob_size_t i = iEnd - 32;
+    __m256i a = _mm256_loadu_si256((void*)(z+i));
+    __m256i b = _mm256_loadu_si256((void*)(z+i+m-1));
+    mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, vF),
+                                                 _mm256_cmpeq_epi8(b, vL)));
+    while( mask ){
+      int k = 31 - __builtin_clz(mask);
+      if( findMatch(z+i+k, zNeedle, m) ){
+        *pFound = 1;
+        return i + k;
+      }
+      mask &= ~(1u<<k);
+    }
+    iEnd = i;
+  }
+  return iEnd;
+}
+#endif
+
+/*
+** Return the offset of the first m-byte needle zNeedle in z[0..n-1],
+** or n if there is none.  An empty needle matches at 0.
+*/
+blob_size_t scan_find(
+  const char *z, blob_size_t n,
+  const char *zNeedle, blob_size_t m
+){
+  blob_size_t i = 0;
+  if( m==0 || m>n ) return m ? n : 0;
+  if( m==1 ){
+    return scanChar(z, n, zNeedle[0]);
+  }
+  if( m>FIND_MAX_FILTER ){
+    const char *p = memmem(z, n, zNeedle, m);
+    return p ? (blob_size_t)(p - z) : n;
+  }
+#ifdef FSL_AVX2
+  if( n-m+1>=32 && fsl_cpu_avx2() ){
+    int found = 0;
+    i = findFirstAvx2(z, n, zNeedle, m, &found);
+    if( found ) return i;
+  }
+#endif
+#ifdef FSL_SSE2
+  {
+    __m128i vF = _mm_set1_epi8(zNeedle[0]);
+    __m128i vL = _mm_set1_epi8(zNeedle[m-1]);
+    for(; i+16<=n-m+1; i+=16){
+      __m128i a = _mm_loadu_si128((void*)(z+i));
+      __m128i b = _mm_loadu_si128((void*)(z+i+m-1));
+      unsigned int mask;
+      mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, vF),
+                                             _mm_cmpeq_epi8(b, vL)));
+      while( mask ){
+        blob_size_t j = i + __builtin_ctz(mask);
+        if( findMatch(z+j, zNeedle, m) ) return j;
+        mask &= mask-1;
+      }
+    }
+  }
+#endif
+  for(; i<=n-m; i++){
+    if( z[i]==zNeedle[0] && z[i+m-1]==zNeedle[m-1]
+     && findMatch(z+i, zNeedle, m) ){
+      return i;
+    }
+  }
+  return n;
+}
+
+/*
+** Return the offset of the last m-byte needle zNeedle in z[0..n-1],
+** or n if there is none.  An empty needle matches at n.  There is no
+** reverse memmem(), so long needles are filtered like short ones.
+*/
+blob_size_t scan_find_last(
+  const char *z, blob_size_t n,
+  const char *zNeedle, blob_size_t m
+){
+  blob_size_t iEnd;             /* Positions below iEnd are unsearched */
+  if( m==0 || m>n ) return n;
+  iEnd = n-m+1;
+#ifdef FSL_AVX2
+  if( iEnd>=32 && fsl_cpu_avx2() ){
+    int found = 0;
+    iEnd = findLastAvx2(z, iEnd, zNeedle, m, &found);
+    if( found ) return iEnd;
+  }
+#endif
+#ifdef FSL_SSE2
+  {
+    __m128i vF = _mm_set1_epi8(zNeedle[0]);
+    __m128i vL = _mm_set1_epi8(zNeedle[m-1]);
+    while( iEnd>=16 ){
+      blob_size_t i = iEnd - 16;
+      __m128i a = _mm_loadu_si128((void*)(z+i));
+      __m128i b = _mm_loadu_si128((void*)(z+i+m-1));
+      unsigned int mask;
+      mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, vF),
+                                             _mm_cmpeq_epi8(b, vL)));
+      while( mask ){
+        int k = 31 - __builtin_clz(mask);
+        if( findMatch(z+i+k, zNeedle, m) ) return i + k;
+        mask &= ~(1u<<k);
+      }
+      iEnd = i;
+    }
+  }
+#endif
+  while( iEnd>0 ){
+    iEnd--;
+    if( z[iEnd]==zNeedle[0] && z[iEnd+m-1]==zNeedle[m-1]
+     && findMatch(z+iEnd, zNeedle, m) ){
+      return iEnd;
+    }
+  }
+  return n;
+}
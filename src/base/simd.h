@@ -0,0 +1,54 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** Private to libfslbase.  Selects the vector kernels that can be built.
+**
+**   FSL_SSE2        SSE2 kernels.  Always available on amd64.
+**   FSL_SSSE3       SSSE3 kernels, compiled with FSL_TARGET_SSSE3 and used
+**                   only when fsl_cpu_ssse3() is true at run time.
+**   FSL_AVX2        AVX2 kernels, compiled with FSL_TARGET_AVX2 and used
+**                   only when fsl_cpu_avx2() is true at run time.
+**   FSL_SHA         SHA extensions kernels, compiled with FSL_TARGET_SHA and
+**                   used only when fsl_cpu_sha() is true at run time.  The
+**                   check runs CPUID, which is slow under a hypervisor, so
+**                   callers keep the answer.
+**
+** Build with -DFSL_NOSIMD ('make -DNOSIMD') for the portable C code only.
+*/
+
+#ifndef _SIMD_H
+#define _SIMD_H
+
+#if !defined(FSL_NOSIMD) && defined(__SSE2__) \
+    && (defined(__x86_64__) || defined(__i386__))
+# include <immintrin.h>
+# define FSL_SSE2 1
+# if defined(__GNUC__) || defined(__clang__)
+#  define FSL_SSSE3 1
+#  define FSL_TARGET_SSSE3 __attribute__((target("ssse3")))
+#  define fsl_cpu_ssse3()  __builtin_cpu_supports("ssse3")
+#  define FSL_AVX2 1
+#  define FSL_TARGET_AVX2  __attribute__((target("avx2")))
+#  define fsl_cpu_avx2()   __builtin_cpu_supports("avx2")
+#  include <cpuid.h>
+#  define FSL_SHA 1
+#  define FSL_TARGET_SHA   __attribute__((target("sha,sse4.1")))
+static inline int fsl_cpu_sha(void){
+  unsigned int a, b, c, d;
+  return __get_cpuid_count(7, 0, &a, &b, &c, &d) && (b>>29 & 1)!=0
+      && __builtin_cpu_supports("sse4.1");
+}
+# endif
+#endif
+
+#endif
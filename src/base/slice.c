@@ -0,0 +1,153 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** Blobs that share one reference-counted buffer.  Each BlobSlice views
+** the whole buffer or a range of it, without a copy.  The buffer is
+** read-only while shared: the first change made to a slice through the
+** blob interfaces copies that slice's bytes into memory from malloc()
+** and drops its reference.  The last reference frees the buffer.
+**
+** The reference count is updated atomically, so slices of one buffer
+** may be handed to and released by different threads.  A single slice
+** must not be used by two threads at once, like any other blob.
+*/
+
+#include "fslbase.h"
+
+/*
+** A buffer shared by one or more slices
+*/
+struct BlobSliceBuf {
+  int nRef;                      /* Number of slices viewing owner */
+  Blob owner;                    /* Content, from malloc() */
+};
+
+/*
+** Drop a reference to a shared buffer and free it with the last one.
+*/
+static void sliceRelease(BlobSliceBuf *pBuf){
+  if( pBuf && __atomic_sub_fetch(&pBuf->nRef, 1, __ATOMIC_ACQ_REL)==0 ){
+    blob_reset(&pBuf->owner);
+    fossil_free(pBuf);
+  }
+}
+
+/*
+** A reallocation function for blobs that view a shared buffer.
+**
+** A newSize of 0 drops the reference and empties the blob.  Any other
+** size copies the bytes of this slice to memory from malloc() and turns
+** the blob into an ordinary one.  Even a smaller size copies, since the
+** caller may then write the nul terminator into the buffer.
+*/
+void blobReallocShared(Blob *pBlob, blob_size_t newSize){
+  BlobSlice *p = (BlobSlice*)pBlob;
+  Blob b = empty_blob;
+  if( newSize>0 ){
+    blobReallocMalloc(&b, newSize);
+    if( b.blobFlags & BLOBFLAG_OverBudget ){
+      pBlob->blobFlags |= BLOBFLAG_OverBudget;
+      return;
+    }
+    if( pBlob->nUsed>newSize ) pBlob->nUsed = newSize;
+    memcpy(b.aData, pBlob->aData, pBlob->nUsed);
+    b.nUsed = pBlob->nUsed;
+    b.iCursor = pBlob->iCursor;
+    b.blobFlags |= pBlob->blobFlags & BLOBFLAG_NotSQL;
+  }
+  sliceRelease(p->pBuf);
+  p->pBuf = 0;
+  *pBlob = b;
+}
+
+/*
+** Make the content of pFrom the shared buffer of slice p.  A buffer
+** from malloc() is taken over as is; any other content is copied.
+** pFrom is left empty.  pFrom may be &p->b.  Any prior content of p is
+** discarded, not freed.  If a memory budget refuses to join the
+** segments of a BlobChain, pFrom is left as it is and p is an empty
+** slice with BLOBFLAG_OverBudget set.
+*/
+void blob_slice_init(BlobSlice *p, Blob *pFrom){
+  BlobSliceBuf *pBuf;
+  Blob b;
+  if( pFrom->xRealloc==blobReallocShared ){
+    if( pFrom!=&p->b ){
+      blob_slice(p, (BlobSlice*)pFrom, 0, blob_size(pFrom));
+      blob_reset(pFrom);
+    }
+    return;
+  }
+  if( pFrom->xRealloc==blobReallocChain
+   && blob_chain_flatten((BlobChain*)pFrom) ){
+    b = empty_blob;
+    b.blobFlags = BLOBFLAG_OverBudget;
+  }else if( pFrom->xRealloc==blobReallocMalloc ){
+    b = *pFrom;
+    *pFrom = empty_blob;
+  }else{
+    b = empty_blob;
+    blob_append(&b, blob_buffer(pFrom), blob_size(pFrom));
+    b.iCursor = pFrom->iCursor;
+    b.blobFlags |= pFrom->blobFlags & BLOBFLAG_NotSQL;
+    blob_reset(pFrom);
+  }
+  if( b.nAlloc==0 ) blob_resize(&b, 0);
+  pBuf = fossil_malloc( sizeof(*pBuf) );
+  pBuf->nRef = 1;
+  pBuf->owner = b;
+  p->b = b;
+  p->b.nAlloc = b.nUsed;
+  p->b.blobFlags &= BLOBFLAG_NotSQL|BLOBFLAG_OverBudget;
+  p->b.xRealloc = blobReallocShared;
+  p->pBuf = pBuf;
+}
+
+/*
+** Make pTo a view of the n bytes of pFrom that start at offset iOfst,
+** clipped to the end of pFrom.  The bytes are not copied.  If pFrom has
+** been written to since it was shared, its new content becomes a shared
+** buffer first.  pTo may be pFrom.  Any prior content of pTo is
+** discarded, not freed, unless pTo is pFrom.
+*/
+void blob_slice(BlobSlice *pTo, BlobSlice *pFrom, blob_size_t iOfst,
+                blob_size_t n){
+  BlobSliceBuf *pBuf;
+  char *z;
+  if( pFrom->b.xRealloc!=blobReallocShared ){
+    blob_slice_init(pFrom, &pFrom->b);
+  }
+  if( iOfst>blob_size(&pFrom->b) ) iOfst = blob_size(&pFrom->b);
+  if( n>blob_size(&pFrom->b) - iOfst ) n = blob_size(&pFrom->b) - iOfst;
+  pBuf = pFrom->pBuf;
+  z = pFrom->b.aData + iOfst;
+  if( pTo==pFrom ){
+    pTo->b.aData = z;
+  }else{
+    __atomic_add_fetch(&pBuf->nRef, 1, __ATOMIC_RELAXED);
+    pTo->b = pFrom->b;
+    pTo->b.aData = z;
+    pTo->pBuf = pBuf;
+  }
+  pTo->b.nUsed = pTo->b.nAlloc = n;
+  pTo->b.iCursor = 0;
+}
+
+/*
+** Return the number of slices sharing the buffer of p, or 0 if p no
+** longer views a shared buffer.
+*/
+int blob_slice_refs(BlobSlice *p){
+  if( p->b.xRealloc!=blobReallocShared ) return 0;
+  return __atomic_load_n(&p->pBuf->nRef, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,378 @@
+/*
+** Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the Simplified BSD License (also
+** known as the "2-Clause License" or "FreeBSD License".)
+**
+** This program is distributed in the hope that it will be useful,
+** but without any warranty; without even the implied warranty of
+** merchantability or fitness for a particular purpose.
+**
+*******************************************************************************
+**
+** Checks and clean-ups run over every text artifact: UTF-8 validation,
+** line ending normalization and whitespace tests.
+**
+** UTF-8 is validated with the lookup algorithm of Keiser and Lemire,
+** "Validating UTF-8 In Less Than One Instruction Per Byte" (2021): three
+** nibble lookups classify each pair of adjacent bytes, and a saturating
+** subtraction finds the bytes that must be the 3rd or 4th of a
+** character.  Carriage returns are removed 16 bytes at a time, with the
+** bytes that stay squeezed together inside 64-bit words.
+*/
+
+#include "fslbase.h"
+#include "simd.h"
+
+/*
+** Error classes of a pair of adjacent bytes, as in Keiser and Lemire
+*/
+#define U8_TOO_SHORT       0x01  /* Lead byte then no continuation */
+#define U8_TOO_LONG        0x02  /* ASCII byte then a continuation */
+#define U8_OVERLONG_3      0x04  /* 0xe0 then 0x80..0x9f */
+#define U8_TOO_LARGE       0x08  /* Above U+10FFFF */
+#define U8_SURROGATE       0x10  /* 0xed then 0xa0..0xbf */
+#define U8_OVERLONG_2      0x20  /* 0xc0 or 0xc1 */
+#define U8_TOO_LARGE_1000  0x40  /* 0xf5..0xff then 0x80..0x8f */
+#define U8_OVERLONG_4      0x40  /* 0xf0 then 0x80..0x8f */
+#define U8_TWO_CONTS       0x80  /* Two continuations in a row */
+#define U8_CARRY           (U8_TOO_SHORT|U8_TOO_LONG|U8_TWO_CONTS)
+
+#ifdef FSL_SSSE3
+/* Classes by the high nibble of the first byte of a pair */
+static const unsigned char utf8Byte1High[16] = {
+  U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+  U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+  U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS,
+  U8_TOO_SHORT | U8_OVERLONG_2,
+  U8_TOO_SHORT,
+  U8_TOO_SHORT | U8_OVERLONG_3 | U8_SURROGATE,
+  U8_TOO_SHORT | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_OVERLONG_4
+};
+
+/* Classes by the low nibble of the first byte of a pair */
+static const unsigned char utf8Byte1Low[16] = {
+  U8_CARRY | U8_OVERLONG_3 | U8_OVERLONG_2 | U8_OVERLONG_4,
+  U8_CARRY | U8_OVERLONG_2,
+  U8_CARRY,
+  U8_CARRY,
+  U8_CARRY | U8_TOO_LARGE,
+  U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+  U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+  U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+  U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+  U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+  U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+  U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+  U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+  U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_SURROGATE,
+  U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+  U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000
+};
+
+/* Classes by the high nibble of the second byte of a pair */
+static const unsigned char utf8Byte2High[16] = {
+  U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+  U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+  U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3
+    | U8_TOO_LARGE_1000 | U8_OVERLONG_4,
+  U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3
+    | U8_TOO_LARGE,
+  U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE
+    | U8_TOO_LARGE,
+  U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE
+    | U8_TOO_LARGE,
+  U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT
+};
+
+/*
+** Validate the whole 16-byte blocks of z[0..n-1].  Return the offset
+** where the blocks end and set *pBad if any of them holds an error.  A
+** character cut by the end of the last block is not an error here.
+*/
+FSL_TARGET_SSSE3
+static blob_size_t utf8Ssse3(const char *z, blob_size_t n, int *pBad){
+  const __m128i t1 = _mm_loadu_si128((const void*)utf8Byte1High);
+  const __m128i t2 = _mm_loadu_si128((const void*)utf8Byte1Low);
+  const __m128i t3 = _mm_loadu_si128((const void*)utf8Byte2High);
+  const __m128i nib = _mm_set1_epi8(0x0f);
+  __m128i prev = _mm_setzero_si128();
+  __m128i err = _mm_setzero_si128();
+  blob_size_t i;
+  for(i=0; i+16<=n; i+=16){
+    __m128i v = _mm_loadu_si128((const void*)(z+i));
+    __m128i p1 = _mm_alignr_epi8(v, prev, 15);
+    __m128i p2 = _mm_alignr_epi8(v, prev, 14);
+    __m128i p3 = _mm_alignr_epi8(v, prev, 13);
+    __m128i sc, must;
+    sc = _mm_shuffle_epi8(t1, _mm_and_si128(_mm_srli_epi16(p1, 4), nib));
+    sc = _mm_and_si128(sc, _mm_shuffle_epi8(t2, _mm_and_si128(p1, nib)));
+    sc = _mm_and_si128(sc,
+           _mm_shuffle_epi8(t3, _mm_and_si128(_mm_srli_epi16(v, 4), nib)));
+    must = _mm_or_si128(_mm_subs_epu8(p2, _mm_set1_epi8(0xe0-0x80)),
+                        _mm_subs_epu8(p3, _mm_set1_epi8(0xf0-0x80)));
+    must = _mm_and_si128(must, _mm_set1_epi8((char)0x80));
+    err = _mm_or_si128(err, _mm_xor_si128(must, sc));
+    prev = v;
+  }
+  *pBad = _mm_movemask_epi8(_mm_cmpeq_epi8(err, _mm_setzero_si128()))
+            != 0xffff;
+  return i;
+}
+#endif
+
+#ifdef FSL_AVX2
+FSL_TARGET_AVX2
+static blob_size_t utf8Avx2(const char *z, blob_size_t n, int *pBad){
+  const __m256i t1 = _mm256_broadcastsi128_si256(
+                        _mm_loadu_si128((const void*)utf8Byte1High));
+  const __m256i t2 = _mm256_broadcastsi128_si256(
+                        _mm_loadu_si128((const void*)utf8Byte1Low));
+  const __m256i t3 = _mm256_broadcastsi128_si256(
+                        _mm_loadu_si128((const void*)utf8Byte2High));
+  const __m256i nib = _mm256_set1_epi8(0x0f);
+  __m256i prev = _mm256_setzero_si256();
+  __m256i err = _mm256_setzero_si256();
+  blob_size_t i;
+  for(i=0; i+32<=n; i+=32){
+    __m256i v = _mm256_loadu_si256((const void*)(z+i));
+    __m256i x = _mm256_permute2x128_si256(prev, v, 0x21);
+    __m256i p1 = _mm256_alignr_epi8(v, x, 15);
+    __m256i p2 = _mm256_alignr_epi8(v, x, 14);
+    __m256i p3 = _mm256_alignr_epi8(v, x, 13);
+    __m256i sc, must;
+    sc = _mm256_shuffle_epi8(t1,
+           _mm256_and_si256(_mm256_srli_epi16(p1, 4), nib));
+    sc = _mm256_and_si256(sc,
+           _mm256_shuffle_epi8(t2, _mm256_and_si256(p1, nib)));
+    sc = _mm256_and_si256(sc, _mm256_shuffle_epi8(t3,
+           _mm256_and_si256(_mm256_srli_epi16(v, 4), nib)));
+    must = _mm256_or_si256(
+             _mm256_subs_epu8(p2, _mm256_set1_epi8(0xe0-0x80)),
+             _mm256_subs_epu8(p3, _mm256_set1_epi8(0xf0-0x80)));
+    must = _mm256_and_si256(must, _mm256_set1_epi8((char)0x80));
+    err = _mm256_or_si256(err, _mm256_xor_si256(must, sc));
+    prev = v;
+  }
+  *pBad = !_mm256_testz_si256(err, err);
+  return i;
+}
+#endif
+
+/*
+** Return true if z[0..n-1] is well-formed UTF-8: no overlong forms, no
+** surrogates, nothing above U+10FFFF and no truncated characters.
+*/
+static int utf8Scalar(const unsigned char *z, blob_size_t n){
+  blob_size_t i = 0;
+  while( i<n ){
+    unsigned char c = z[i];
+    unsigned char lo = 0x80, hi = 0xbf;
+    int nCont;
+    if( c<0x80 ){ i++; continue; }
+    if( c<0xc2 ) return 0;
+    if( c<0xe0 ){
+      nCont = 1;
+    }else if( c<0xf0 ){
+      nCont = 2;
+      if( c==0xe0 ) lo = 0xa0;
+      if( c==0xed ) hi = 0x9f;
+    }else if( c<0xf5 ){
+      nCont = 3;
+      if( c==0xf0 ) lo = 0x90;
+      if( c==0xf4 ) hi = 0x8f;
+    }else{
+      return 0;
+    }
+    if( n-i<=(blob_size_t)nCont ) return 0;
+    if( z[i+1]<lo || z[i+1]>hi ) return 0;
+    for(i+=2; --nCont>0; i++){
+      if( (z[i]&0xc0)!=0x80 ) return 0;
+    }
+  }
+  return 1;
+}
+
+/*
+** Return true if the content of pBlob is well-formed UTF-8.  A 0x00
+** byte is valid UTF-8.
+*/
+int blob_is_utf8(Blob *pBlob){
+  const char *z;
+  blob_size_t n, i = 0;
+  int bad = 0;
+  if( pBlob->xRealloc==blobReallocChain ) blob_materialize(pBlob);
+  z = blob_buffer(pBlob);
+  n = blob_size(pBlob);
+#ifdef FSL_AVX2
+  if( n>=32 && fsl_cpu_avx2() ){
+    i = utf8Avx2(z, n, &bad);
+  }
+#endif
+#ifdef FSL_SSSE3
+  if( i==0 && n>=16 && fsl_cpu_ssse3() ){
+    i = utf8Ssse3(z, n, &bad);
+  }
+#endif
+  if( bad ) return 0;
+  /* Back up to the start of a character the blocks may have cut */
+  if( i>0 ){
+    blob_size_t j = i;
+    while( j>0 && i-j<3 && (z[j-1]&0xc0)==0x80 ){ j--; }
+    if( j>0 && (unsigned char)z[j-1]>=0xc0 ) j--;
+    i = j;
+  }
+  return utf8Scalar((const unsigned char*)z+i, n-i);
+}
+
+#ifdef FSL_SSE2
+/*
+** Write the 16 bytes of a, less those whose bit is set in m, to zOut.
+** Return the number of bytes kept.  The bytes are squeezed together
+** 8 at a time inside a 64-bit word, in memory order, so up to 16 bytes
+** are stored: zOut may run over its result but never past a+16 when
+** zOut<=a.
+*/
+static blob_size_t crCompact(char *zOut, const char *a, unsigned int m){
+  blob_size_t n = 0;
+  int h;
+  for(h=0; h<16; h+=8){
+    unsigned int mh = (m>>h) & 0xff;
+    blob_size_t nKeep = 8;
+    u64 x;
+    memcpy(&x, a+h, 8);
+    while( mh ){
+      int k = 31 - __builtin_clz(mh);
+      u64 lo = ((u64)1<<(8*k)) - 1;
+      x = (x & lo) | ((x>>8) & ~lo);
+      mh &= ~(1u<<k);
+      nKeep--;
+    }
+    memcpy(zOut+n, &x, 8);
+    n += nKeep;
+  }
+  return n;
+}
+#endif
+
+#ifdef FSL_AVX2
+/*
+** AVX2 body of textFixCr().  Start reading at *pI and writing at *pJ
+** and advance both past the whole 32-byte blocks.
+*/
+FSL_TARGET_AVX2
+static void crAvx2(char *z, blob_size_t n, blob_size_t *pI, blob_size_t *pJ,
+                   int toLf){
+  const __m256i vCr = _mm256_set1_epi8('\r');
+  const __m256i vLf = _mm256_set1_epi8('\n');
+  blob_size_t i = *pI, j = *pJ;
+  char a[32];
+  for(; i+32+toLf<=n; i+=32){
+    __m256i v = _mm256_loadu_si256((void*)(z+i));
+    __m256i cr = _mm256_cmpeq_epi8(v, vCr);
+    unsigned int m = _mm256_movemask_epi8(cr);
+    if( m==0 ){
+      _mm256_storeu_si256((void*)(z+j), v);
+      j += 32;
+      continue;
+    }
+    if( toLf ){
+      __m256i lf = _mm256_cmpeq_epi8(
+                     _mm256_loadu_si256((void*)(z+i+1)), vLf);
+      m = _mm256_movemask_epi8(_mm256_and_si256(cr, lf));
+      v = _mm256_blendv_epi8(v, vLf, cr);
+    }
+    _mm256_storeu_si256((void*)a, v);
+    j += crCompact(z+j, a, m & 0xffff);
+    j += crCompact(z+j, a+16, m>>16);
+  }
+  *pI = i;
+  *pJ = j;
+}
+#endif
+
+/*
+** Common body of blob_remove_cr() (toLf==0) and blob_to_lf_only()
+** (toLf==1).  A blob without '\r' is left alone, static or not.
+*/
+static void textFixCr(Blob *p, int toLf){
+  char *z;
+  const char *zCr;
+  blob_size_t n, i, j;
+  if( p->xRealloc==blobReallocChain ) blob_materialize(p);
+  n = blob_size(p);
+  zCr = n ? memchr(blob_buffer(p), '\r', n) : 0;
+  if( zCr==0 ) return;
+  i = j = zCr - blob_buffer(p);
+  z = blob_materialize(p);
+  if( z!=blob_buffer(p) ) return;   /* The copy was refused */
+#ifdef FSL_AVX2
+  if( n-i>=64 && fsl_cpu_avx2() ){
+    crAvx2(z, n, &i, &j, toLf);
+  }
+#endif
+#ifdef FSL_SSE2
+  {
+    const __m128i vCr = _mm_set1_epi8('\r');
+    const __m128i vLf = _mm_set1_epi8('\n');
+    char a[16];
+    for(; i+16+toLf<=n; i+=16){
+      __m128i v = _mm_loadu_si128((void*)(z+i));
+      __m128i cr = _mm_cmpeq_epi8(v, vCr);
+      unsigned int m = _mm_movemask_epi8(cr);
+      if( m==0 ){
+        _mm_storeu_si128((void*)(z+j), v);
+        j += 16;
+        continue;
+      }
+      if( toLf ){
+        __m128i lf = _mm_cmpeq_epi8(_mm_loadu_si128((void*)(z+i+1)), vLf);
+        m = _mm_movemask_epi8(_mm_and_si128(cr, lf));
+        v = _mm_or_si128(_mm_andnot_si128(cr, v), _mm_and_si128(cr, vLf));
+      }
+      _mm_storeu_si128((void*)a, v);
+      j += crCompact(z+j, a, m);
+    }
+  }
+#endif
+  while( i<n ){
+    char c = z[i++];
+    if( c=='\r' ){
+      if( !toLf || (i<n && z[i]=='\n') ) continue;
+      c = '\n';
+    }
+    z[j++] = c;
+  }
+  p->nUsed = j;
+  z[j] = 0;
+}
+
+/*
+** Remove every '\r' byte from pBlob.
+*/
+void blob_remove_cr(Blob *pBlob){
+  textFixCr(pBlob, 0);
+}
+
+/*
+** Convert every "\r\n" of pBlob into "\n", and every '\r' that is not
+** followed by '\n' into '\n' too.
+*/
+void blob_to_lf_only(Blob *pBlob){
+  textFixCr(pBlob, 1);
+}
+
+/*
+** Return true if the input string is NULL or all whitespace.
+** Return false if the input string contains text.
+**
+** libfsl: util.c source.  strlen() and scan_nonspace() are both
+** vectorized.
+*/
+int fossil_all_whitespace(const char *z){
+  blob_size_t n;
+  if( z==0 ) return 1;
+  n = strlen(z);
+  return scan_nonspace(z, n)==n;
+}
@@ -94,16 +94,6 @@ void *fossil_realloc(void *p, size_t n){
 ** some international character sets.  So here is a substitute.
 ** libfsl: blob.c source
 */
-static int fossil_isspace(char c){
+int fossil_isspace(char c){
   return c==' ' || (c<='\r' && c>='\t');
 }
-
-/*
-** Return true if the input string is NULL or all whitespace.
-** Return false if the input string contains text.
-*/
-int fossil_all_whitespace(const char *z){
-  if( z==0 ) return 1;
-  while( fossil_isspace(z[0]) ){ z++; }
-  return z[0]==0;
-}
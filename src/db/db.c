@@ -283,7 +283,7 @@ int db_vprepare(Stmt *pStmt, int flags, const char *zFormat, va_list ap){
   int prepFlags = 0;
   char *zSql;
   const char *zExtra = 0;
-  blob_zero(&pStmt->sql);
+  blob_init_inline(&pStmt->sql, pStmt->zSqlBuf, sizeof(pStmt->zSqlBuf));
   blob_vappendf(&pStmt->sql, zFormat, ap);
   va_end(ap);
   zSql = blob_str(&pStmt->sql);
@@ -419,10 +419,11 @@ int db_int(int iDflt, const char *zSql, ...){
 */
 int db_multi_exec(const char *zSql, ...){
   Blob sql;
+  char zBuf[DB_SQL_INLINE];
   int rc;
   va_list ap;
 
-  blob_init(&sql, 0, 0);
+  blob_init_inline(&sql, zBuf, sizeof(zBuf));
   va_start(ap, zSql);
   blob_vappendf(&sql, zSql, ap);
   va_end(ap);
@@ -431,6 +432,28 @@ int db_multi_exec(const char *zSql, ...){
   return rc;
 }
 
+/*
+** Run a query and add the value of the first column of each row to
+** filter p, as text or as a blob.  NULL values are skipped.  Return the
+** number of values added.
+*/
+int db_filter_add(BlobFilter *p, const char *zSql, ...){
+  va_list ap;
+  Stmt s;
+  int n = 0;
+  va_start(ap, zSql);
+  db_vprepare(&s, 0, zSql, ap);
+  va_end(ap);
+  while( db_step(&s)==SQLITE_ROW ){
+    if( sqlite3_column_type(s.pStmt, 0)==SQLITE_NULL ) continue;
+    blob_filter_add(p, sqlite3_column_blob(s.pStmt, 0),
+                    sqlite3_column_bytes(s.pStmt, 0));
+    n++;
+  }
+  db_finalize(&s);
+  return n;
+}
+
 /*
 ** Extract text, integer, or blob values from the N-th column of the
 ** current row.
@@ -484,6 +507,17 @@ const char *db_column_text(Stmt *pStmt, int N){
   return (char*)sqlite3_column_text(pStmt->pStmt, N);
 }
 
+/*
+** Return the text of the N-th column of the current row as a string of
+** intern pool p, or NULL if the column is NULL.  Unlike the result of
+** db_column_text(), it stays valid after the next db_step().
+*/
+const char *db_column_intern(Stmt *pStmt, int N, BlobIntern *p){
+  const char *z = (const char*)sqlite3_column_text(pStmt->pStmt, N);
+  if( z==0 ) return 0;
+  return blob_intern(p, z, sqlite3_column_bytes(pStmt->pStmt, N));
+}
+
 /*
 ** Prepare a Stmt.  Assume that the Stmt is previously uninitialized.
 ** If the input string contains multiple SQL statements, only the first
@@ -639,7 +673,15 @@ int db_exec_sql(const char *z){
 int db_prepare_blob(Stmt *pStmt, Blob *pSql){
   int rc;
   char *zSql;
-  pStmt->sql = *pSql;
+  if( pSql->xRealloc==blobReallocInline ){
+    /* libfsl: the buffer of pSql belongs to the caller, copy the text */
+    blob_init_inline(&pStmt->sql, pStmt->zSqlBuf, sizeof(pStmt->zSqlBuf));
+    blob_append(&pStmt->sql, blob_buffer(pSql), blob_size(pSql));
+    pStmt->sql.blobFlags |= pSql->blobFlags & BLOBFLAG_NotSQL;
+    blob_reset(pSql);
+  }else{
+    pStmt->sql = *pSql;
+  }
   blob_init(pSql, 0, 0);
   zSql = blob_sql_text(&pStmt->sql);
   db.nPrepare++;
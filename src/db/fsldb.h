@@ -36,12 +36,18 @@ extern Global g;
 ** DB
 */
 
+/*
+** SQL text up to this size is built inside the Stmt itself
+*/
+#define DB_SQL_INLINE  128
+
 /*
 ** An single SQL statement is represented as an instance of the following
 ** structure.
 */
 struct Stmt {
   Blob sql;               /* The SQL for this statement */
+  char zSqlBuf[DB_SQL_INLINE]; /* Initial space for sql */
   sqlite3_stmt *pStmt;    /* The results of sqlite3_prepare_v2() */
   Stmt *pNext, *pPrev;    /* List of all unfinalized statements */
   int nStep;              /* Number of sqlite3_step() calls */
@@ -62,10 +68,12 @@ void db_end_transaction(int rollbackFlag);
 i64 db_int64(i64 iDflt, const char *zSql, ...);
 int db_int(int iDflt, const char *zSql, ...);
 int db_multi_exec(const char *zSql, ...);
+int db_filter_add(BlobFilter *p, const char *zSql, ...);
 int db_column_int(Stmt *pStmt, int N);
 i64 db_column_int64(Stmt *pStmt, int N);
 int db_database_slot(const char *zLabel);
 const char *db_column_text(Stmt *pStmt, int N);
+const char *db_column_intern(Stmt *pStmt, int N, BlobIntern *p);
 int db_prepare_ignore_error(Stmt *pStmt, const char *zFormat, ...);
 int db_prepare(Stmt *pStmt, const char *zFormat, ...);
 void db_init_database(const char *zFileName, const char *zSchema, ...);
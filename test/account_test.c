@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <setjmp.h>
+#include <unistd.h>
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+#define NBATCH	64
+
+static int nSoft, nHard;
+static jmp_buf env;
+
+static int
+budget(void *pArg, int iCat, int eBudget, u64 nCur, u64 nMore)
+{
+	assert(pArg == &env);
+	if (eBudget == BLOB_BUDGET_SOFT) {
+		nSoft++;
+		return (0);
+	}
+	nHard++;
+	if (iCat == 3)
+		longjmp(env, 1);
+	if (iCat == 5)
+		return (BLOB_BUDGET_FAIL);
+	/* raise the budget and retry */
+	blob_account_budget(iCat, 0, nCur + nMore);
+	return (1);
+}
+
+int
+main(void)
+{
+	Blob a = empty_blob, b = empty_blob;
+	BlobSlice s, t;
+	BlobAccount acct;
+	BlobDeflate z;
+	BlobChain chain;
+	Blob *apIn[NBATCH], aOut[NBATCH];
+	const char teststr[] = "black sheep wall";
+	const char *tmpfile = "/tmp/testme-account-mmap.txt";
+	u64 nCur;
+	int i;
+
+	cez_test_start();
+	blob_init(&a, teststr, -1);
+	assert(blob_write_to_file(&a, tmpfile) == 16);
+	/* nothing is counted before accounting is enabled */
+	blob_append(&a, teststr, -1);
+	blob_account_enable(budget, &env);
+	blob_account_get(0, &acct);
+	assert(acct.nCur == 0 && acct.nAlloc == 0);
+	blob_reset(&a);
+	blob_account_get(0, &acct);
+	assert(acct.nCur == 0);
+	/* bytes held, peak and count follow the buffer */
+	assert(blob_account_category(1) == 0);
+	blob_append(&a, teststr, -1);
+	blob_account_get(1, &acct);
+	assert(acct.nCur == a.nAlloc && acct.nAlloc == 1);
+	for (i = 0; i < 100; i++)
+		blob_append(&a, teststr, -1);
+	blob_account_get(1, &acct);
+	assert(acct.nCur == a.nAlloc && acct.nPeak == a.nAlloc);
+	assert(acct.nAlloc > 1);
+	/* buffers are credited to the category they were charged to */
+	assert(blob_account_category(2) == 1);
+	blob_append(&b, teststr, -1);
+	blob_reset(&a);
+	blob_account_get(1, &acct);
+	assert(acct.nCur == 0 && acct.nPeak >= 1600);
+	blob_account_get(2, &acct);
+	assert(acct.nCur == b.nAlloc);
+	blob_reset(&b);
+	blob_account_get(2, &acct);
+	assert(acct.nCur == 0);
+	/* the soft budget calls back once, on crossing */
+	blob_account_budget(2, 1000, 0);
+	for (i = 0; i < 200; i++)
+		blob_append(&a, teststr, -1);
+	assert(nSoft == 1 && nHard == 0);
+	blob_reset(&a);
+	/* the hard budget calls back before allocating */
+	blob_account_budget(2, 0, 1000);
+	for (i = 0; i < 200; i++)
+		blob_append(&a, teststr, -1);
+	blob_account_get(2, &acct);
+	assert(nHard > 0 && acct.mxHard >= acct.nCur);
+	assert(acct.nCur == a.nAlloc);
+	blob_reset(&a);
+	/* recover from a hard budget with longjmp() */
+	blob_account_category(3);
+	blob_account_budget(3, 0, 1000);
+	blob_append(&a, teststr, -1);
+	nHard = 0;
+	if (setjmp(env) == 0) {
+		for (i = 0; i < 200; i++)
+			blob_append(&a, teststr, -1);
+		assert(0);
+	}
+	assert(nHard == 1 && blob_size(&a) % 16 == 0);
+	blob_account_get(3, &acct);
+	assert(acct.nCur == a.nAlloc && acct.nCur <= 1000);
+	blob_reset(&a);
+	blob_account_budget(3, 0, 0);
+	/* shared buffers are counted once, copies on write as they happen */
+	blob_account_category(4);
+	blob_append(&a, teststr, -1);
+	blob_slice_init(&s, &a);
+	blob_slice(&t, &s, 6, 5);
+	blob_account_get(4, &acct);
+	assert(acct.nCur > 0 && acct.nCur < 200);
+	blob_reset(&s.b);
+	blob_append(&t.b, "!", 1);
+	assert(strcmp(blob_str(&t.b), "sheep!") == 0);
+	blob_account_get(4, &acct);
+	assert(acct.nCur == t.b.nAlloc);
+	blob_reset(&t.b);
+	blob_account_get(4, &acct);
+	assert(acct.nCur == 0);
+	/* refuse past the hard budget and carry on */
+	blob_account_category(5);
+	blob_account_budget(5, 0, 1000);
+	nHard = 0;
+	for (i = 0; i < 200; i++)
+		blob_append(&a, teststr, -1);
+	assert(nHard > 0 && blob_over_budget(&a));
+	assert(blob_size(&a) > 0 && blob_size(&a) % 16 == 0);
+	assert(blob_size(&a) < a.nAlloc && blob_str(&a)[blob_size(&a)] == 0);
+	assert(memcmp(blob_buffer(&a) + blob_size(&a) - 16, teststr, 16) == 0);
+	blob_account_get(5, &acct);
+	assert(acct.nCur == a.nAlloc && acct.nCur <= 1000);
+	assert(blob_resize(&a, 5000) == 1 && blob_size(&a) < 1000);
+	assert(blob_reserve(&a, 5000) == 1);
+	assert(blob_append_space(&a, 5000) == NULL);
+	assert(blob_compress(&a, &b) == 1 && blob_size(&b) == 0);
+	/* smaller requests still succeed and the error stays set */
+	assert(blob_resize(&a, 16) == 0);
+	assert(blob_eq(&a, "black sheep wall") && blob_over_budget(&a));
+	blob_over_budget_clear(&a);
+	assert(!blob_over_budget(&a));
+	/* a static blob keeps its content when the copy is refused */
+	blob_account_budget(5, 0, 1);
+	blob_init(&b, teststr, 11);
+	assert(strcmp(blob_str(&b), "") == 0 && blob_over_budget(&b));
+	assert(blob_size(&b) == 11 && blob_buffer(&b) == teststr);
+	blob_reset(&b);
+	assert(!blob_over_budget(&b));
+	/* a stream fails, without writing, if its output is refused */
+	assert(blob_deflate_init(&z, &b, 6) == 1 && blob_size(&b) == 0);
+	assert(blob_deflate_finish(&z) == 1);
+	blob_reset(&b);
+	blob_account_budget(5, 0, 0);
+	assert(blob_deflate_init(&z, &b, 6) == 0);
+	blob_account_budget(5, 0, 1);
+	for (i = 0; i < 10000; i++)
+		blob_deflate_append(&z, teststr, -1);
+	assert(blob_deflate_finish(&z) == 1 && blob_over_budget(&b));
+	blob_reset(&b);
+	/* and so does a slice written to */
+	blob_slice_init(&s, &a);
+	blob_slice(&t, &s, 6, 5);
+	blob_append(&t.b, "!", 1);
+	assert(blob_over_budget(&t.b) && blob_eq(&t.b, "sheep"));
+	assert(blob_slice_refs(&t) == 2);
+	blob_reset(&t.b);
+	blob_reset(&s.b);
+	blob_account_get(5, &acct);
+	assert(acct.nCur == 0);
+	/* mappings copied to the heap and chain segments are counted */
+	assert(blob_read_mmap(&b, tmpfile, BLOB_MMAP_NORMAL) == 16);
+	blob_append(&b, "!", 1);
+	assert(blob_over_budget(&b) && blob_eq(&b, "black sheep wall"));
+	blob_chain_init(&chain, 0);
+	blob_chain_append(&chain, teststr, -1);
+	assert(blob_over_budget(&chain.tail) && blob_chain_size(&chain) == 0);
+	blob_account_get(5, &acct);
+	assert(acct.nCur == 0);
+	blob_account_budget(5, 0, 0);
+	blob_append(&b, "!", 1);
+	assert(blob_eq(&b, "black sheep wall!"));
+	for (i = 0; i < 10000; i++)
+		blob_chain_append(&chain, teststr, -1);
+	blob_account_get(5, &acct);
+	assert(acct.nCur > b.nAlloc + 16 * 10000);
+	blob_account_budget(5, 0, acct.nCur);
+	assert(strcmp(blob_str(&chain.tail), "") == 0);
+	assert(blob_over_budget(&chain.tail));
+	assert(blob_chain_size(&chain) == 16 * 10000);
+	blob_account_budget(5, 0, 0);
+	assert(blob_str(&chain.tail)[16 * 10000 - 1] == 'l');
+	blob_reset(&chain.tail);
+	blob_reset(&b);
+	blob_account_get(5, &acct);
+	assert(acct.nCur == 0);
+	unlink(tmpfile);
+	/* raising the budget lets the blob grow again */
+	blob_account_budget(5, 0, 0);
+	for (i = 0; i < 200; i++)
+		blob_append(&a, teststr, -1);
+	assert(blob_size(&a) == 16 * 200 && !blob_over_budget(&a));
+	blob_reset(&a);
+	/* hashes made on pool threads count in the caller's category */
+	blob_account_category(6);
+	for (i = 0; i < NBATCH; i++) {
+		apIn[i] = &a;
+		aOut[i] = empty_blob;
+	}
+	blob_account_get(0, &acct);
+	nCur = acct.nCur;
+	assert(hname_hash_batch(apIn, aOut, NBATCH, HNAME_ALG_K256, 4) == 0);
+	blob_account_get(0, &acct);
+	assert(acct.nCur == nCur);
+	blob_account_get(6, &acct);
+	for (i = 0, nCur = 0; i < NBATCH; i++)
+		nCur += aOut[i].nAlloc;
+	assert(acct.nCur == nCur && acct.nAlloc == NBATCH);
+	for (i = 0; i < NBATCH; i++)
+		blob_reset(&aOut[i]);
+	blob_account_get(6, &acct);
+	assert(acct.nCur == 0);
+
+	return (0);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+int
+main(void)
+{
+	BlobArena arena = BLOB_ARENA_INITIALIZER;
+	Blob a, b;
+	const char teststr[] = "black sheep wall";
+	char *z;
+	int i;
+
+	cez_test_start();
+	blob_init_arena(&a, &arena);
+	assert(blob_size(&a) == 0);
+	assert(strcmp(blob_str(&a), "") == 0);
+	assert(arena.nMalloc == 1);
+	blob_append(&a, teststr, strlen(teststr));
+	assert(blob_size(&a) == 16);
+	assert(strcmp(blob_str(&a), teststr) == 0);
+	/* the most recent block grows in place */
+	z = blob_buffer(&a);
+	blob_append(&a, teststr, strlen(teststr));
+	assert(blob_buffer(&a) == z);
+	assert(strcmp(blob_str(&a), "black sheep wallblack sheep wall") == 0);
+	/* interleaved blobs */
+	blob_init_arena(&b, &arena);
+	blob_append_sql(&b, "SELECT * FROM TABLE WHERE id = '%d'", 1);
+	for (i = 0; i < 100; i++)
+		blob_append(&a, teststr, strlen(teststr));
+	assert(blob_size(&a) == 102 * 16);
+	assert(strncmp(blob_str(&a), teststr, 16) == 0);
+	assert(strcmp(blob_sql_text(&b),
+	    "SELECT * FROM TABLE WHERE id = '1'") == 0);
+	blob_resize(&a, 5);
+	assert(strcmp(blob_str(&a), "black") == 0);
+	assert(arena.nMalloc == 1);
+	/* reset keeps the blob attached to its arena */
+	blob_reset(&b);
+	assert(blob_size(&b) == 0);
+	assert(b.xRealloc == blobReallocArena);
+	blob_append(&b, teststr, strlen(teststr));
+	assert(strcmp(blob_str(&b), teststr) == 0);
+	/* blocks larger than a chunk get a chunk of their own */
+	blob_resize(&b, BLOB_ARENA_CHUNK * 2);
+	assert(blob_size(&b) == BLOB_ARENA_CHUNK * 2);
+	assert(strncmp(blob_buffer(&b), teststr, 16) == 0);
+	assert(arena.nMalloc == 2);
+	blob_arena_reset(&arena);
+	blob_init_arena(&a, &arena);
+	blob_append(&a, teststr, strlen(teststr));
+	assert(strcmp(blob_str(&a), teststr) == 0);
+	assert(arena.nMalloc == 2);
+	blob_arena_free(&arena);
+	assert(arena.pChunk == NULL);
+
+	return (0);
+}
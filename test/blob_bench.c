@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Blob allocation benchmarks.  Not part of 'make test', run with
+ * 'make bench'.
+ */
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fslbase.h"
+
+#define NREQUEST	20000	/* simulated requests */
+#define NSTMT		50	/* SQL statements built per request */
+#define NTERM		8	/* terms appended to each statement */
+#define NROW		2000000	/* rows appended to a dump */
+#define NINLINE		128	/* inline buffer, as in struct Stmt */
+#define NCARD		2000000	/* F-cards in the parsed manifest */
+
+static unsigned int nCall;	/* allocator calls seen by countRealloc() */
+
+/*
+ * blobReallocMalloc() wrapper counting the calls which really reach
+ * malloc(), realloc() or free().
+ */
+static void
+countRealloc(Blob *pBlob, blob_size_t newSize)
+{
+	char *aData = pBlob->aData;
+	blob_size_t nAlloc = pBlob->nAlloc;
+
+	blobReallocMalloc(pBlob, newSize);
+	if (pBlob->aData != aData || pBlob->nAlloc != nAlloc)
+		nCall++;
+}
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+static void
+build_sql(Blob *pSql, int iStmt)
+{
+	int i;
+
+	blob_append_sql(pSql, "SELECT rid, uuid, size FROM blob WHERE rid=%d",
+	    iStmt);
+	for (i = 0; i < NTERM; i++)
+		blob_append_sql(pSql, " UNION ALL SELECT rid, uuid, size FROM"
+		    " blob WHERE uuid=%Q AND size>%d", "5a1d2b8c4e0f", i);
+}
+
+static void
+bench_malloc(void)
+{
+	Blob sql;
+	unsigned long len = 0;
+	double t;
+	int i, j;
+
+	nCall = 0;
+	t = now();
+	for (i = 0; i < NREQUEST; i++) {
+		for (j = 0; j < NSTMT; j++) {
+			sql = empty_blob;
+			sql.xRealloc = countRealloc;
+			build_sql(&sql, j);
+			len += blob_size(&sql);
+			countRealloc(&sql, 0);
+		}
+	}
+	t = now() - t;
+	printf("%-24s %10u allocator calls %10.3f ms (%lu bytes)\n",
+	    "blobReallocMalloc", nCall, t, len);
+}
+
+static void
+bench_cache(void)
+{
+	BlobCacheStats st;
+	Blob sql;
+	unsigned long len = 0;
+	double t;
+	int i, j;
+
+	t = now();
+	blob_cache_enable(1 << 20);
+	for (i = 0; i < NREQUEST; i++) {
+		for (j = 0; j < NSTMT; j++) {
+			sql = empty_blob;
+			build_sql(&sql, j);
+			len += blob_size(&sql);
+			blob_reset(&sql);
+		}
+	}
+	blob_cache_enable(0);
+	t = now() - t;
+	blob_cache_stats(&st);
+	printf("%-24s %10llu allocator calls %10.3f ms (%lu bytes)\n",
+	    "blob_cache_enable", st.nMalloc + st.nFree, t, len);
+}
+
+static void
+bench_arena(void)
+{
+	BlobArena arena = BLOB_ARENA_INITIALIZER;
+	Blob sql;
+	unsigned long len = 0;
+	double t;
+	int i, j;
+
+	t = now();
+	for (i = 0; i < NREQUEST; i++) {
+		for (j = 0; j < NSTMT; j++) {
+			blob_init_arena(&sql, &arena);
+			build_sql(&sql, j);
+			len += blob_size(&sql);
+		}
+		blob_arena_reset(&arena);
+	}
+	blob_arena_free(&arena);
+	t = now() - t;
+	printf("%-24s %10u allocator calls %10.3f ms (%lu bytes)\n",
+	    "blobReallocArena", arena.nMalloc + 1, t, len);
+}
+
+static void
+bench_append(const char *zName, BlobGrowFunc xGrow, unsigned int nReserve)
+{
+	static const char zRow[] =
+	    "INSERT INTO tbl_test VALUES(42,'testuser42');\n";
+	Blob dump = empty_blob;
+	unsigned long len;
+	double t;
+	int i;
+
+	blob_set_growth(xGrow);
+	nCall = 0;
+	t = now();
+	dump.xRealloc = countRealloc;
+	if (nReserve)
+		blob_reserve(&dump, nReserve);
+	for (i = 0; i < NROW; i++)
+		blob_append(&dump, zRow, sizeof(zRow) - 1);
+	len = blob_size(&dump);
+	countRealloc(&dump, 0);
+	t = now() - t;
+	printf("%-24s %10u reallocs %10.3f ms %8.1f MB/s\n",
+	    zName, nCall, t, len / t / 1e3);
+	blob_set_growth(NULL);
+}
+
+static void
+bench_report(const char *zName, int useChain)
+{
+	BlobChain chain;
+	Blob report = empty_blob;
+	Blob *pOut;
+	double t;
+	int fd, i;
+
+	fd = open("/dev/null", O_WRONLY);
+	nCall = 0;
+	t = now();
+	if (useChain) {
+		blob_chain_init(&chain, 0);
+		pOut = &chain.tail;
+	} else {
+		report.xRealloc = countRealloc;
+		pOut = &report;
+	}
+	for (i = 0; i < NROW; i++)
+		blob_append_sql(pOut, "%8d | %-20s | %Q\n", i, "testuser", "it's");
+	if (useChain) {
+		blob_chain_write(&chain, fd);
+		blob_chain_reset(&chain);
+	} else {
+		write(fd, blob_buffer(&report), blob_size(&report));
+		countRealloc(&report, 0);
+	}
+	t = now() - t;
+	close(fd);
+	printf("%-24s %10u reallocs %10.3f ms\n", zName, nCall, t);
+}
+
+/*
+ * blobReallocInline() wrapper.  Once the blob leaves its inline buffer
+ * the calls are counted by countRealloc().
+ */
+static void
+countInline(Blob *pBlob, blob_size_t newSize)
+{
+	char *aData = pBlob->aData;
+
+	blobReallocInline(pBlob, newSize);
+	if (pBlob->aData != aData) {
+		nCall++;
+		pBlob->xRealloc = countRealloc;
+	}
+}
+
+static void
+bench_small(const char *zName, int useInline)
+{
+	Blob sql;
+	char zSpace[NINLINE];
+	unsigned long len = 0;
+	double t;
+	int i;
+
+	nCall = 0;
+	t = now();
+	for (i = 0; i < NREQUEST * NSTMT; i++) {
+		/* the SQL text of db_prepare() */
+		if (useInline) {
+			blob_init_inline(&sql, zSpace, sizeof(zSpace));
+			sql.xRealloc = countInline;
+		} else {
+			sql = empty_blob;
+			sql.xRealloc = countRealloc;
+		}
+		blob_append_sql(&sql, "SELECT name FROM tbl_test WHERE id=%d", i);
+		len += strlen(blob_buffer(&sql));
+		sql.xRealloc(&sql, 0);
+	}
+	t = now() - t;
+	printf("%-24s %10.2f allocator calls/prepare %10.3f ms\n", zName,
+	    (double)nCall / (NREQUEST * NSTMT), t);
+}
+
+/*
+ * Tokenize every line of a manifest, with blob_line() and blob_token()
+ * or with the byte loops they replace.
+ */
+static void
+bench_scan(const char *zName, Blob *pManifest, int useScan)
+{
+	Blob line, tok;
+	const char *z = blob_buffer(pManifest);
+	unsigned long nTok = 0;
+	blob_size_t i, n = blob_size(pManifest);
+	double t;
+
+	t = now();
+	if (useScan) {
+		pManifest->iCursor = 0;
+		while (blob_line(pManifest, &line)) {
+			while (blob_token(&line, &tok))
+				nTok++;
+		}
+	} else {
+		for (i = 0; i < n; ) {
+			while (i < n && fossil_isspace(z[i]))
+				i++;
+			if (i < n)
+				nTok++;
+			while (i < n && !fossil_isspace(z[i]))
+				i++;
+		}
+	}
+	t = now() - t;
+	printf("%-24s %10lu tokens %10.0f MB/s\n", zName, nTok,
+	    n / 1e3 / t);
+}
+
+int
+main(void)
+{
+	Blob manifest = empty_blob;
+	int i;
+
+	printf("%d requests, %d statements each\n", NREQUEST, NSTMT);
+	bench_malloc();
+	bench_cache();
+	bench_arena();
+	printf("%d appended rows\n", NROW);
+	bench_append("blobGrowDefault", blobGrowDefault, 0);
+	bench_append("blobGrowDouble", blobGrowDouble, 0);
+	bench_append("blobGrowOneHalf", blobGrowOneHalf, 0);
+	bench_append("blobGrowPage", blobGrowPage, 0);
+	bench_append("blob_reserve", blobGrowDefault, NROW * 46);
+	printf("%d report lines written to /dev/null\n", NROW);
+	bench_report("Blob", 0);
+	bench_report("BlobChain", 1);
+	printf("%d short SQL statements\n", NREQUEST * NSTMT);
+	bench_small("empty_blob", 0);
+	bench_small("blob_init_inline", 1);
+	for (i = 0; i < NCARD; i++)
+		blob_append_sql(&manifest, "F src/module%07d/file.c "
+		    "%040x%024x\n", i, i * 2654435761u, i);
+	printf("%d manifest lines, %lu bytes\n", NCARD,
+	    (unsigned long)blob_size(&manifest));
+	bench_scan("byte loop", &manifest, 0);
+	bench_scan("blob_line/blob_token", &manifest, 1);
+	blob_reset(&manifest);
+
+	return (0);
+}
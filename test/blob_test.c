@@ -34,8 +34,12 @@
 int
 main(void)
 {
-	Blob mystr = empty_blob;
+	Blob mystr = empty_blob, other;
+	BlobCacheStats st;
 	const char teststr[] = "black sheep wall";
+	char zSpace[24];
+	char *z;
+	int i;
 
 	cez_test_start();
 	assert(blob_size(&mystr) == 0);
@@ -80,6 +84,142 @@ main(void)
 	assert(strcmp(blob_sql_text(&mystr), "''showme'' more showme 34") == 0);
 	blob_reset(&mystr);
 	assert(blob_size(&mystr) == 0);
+	/* reserve */
+	blob_reserve(&mystr, 1000);
+	assert(mystr.nAlloc > 1000);
+	assert(blob_size(&mystr) == 0);
+	z = blob_buffer(&mystr);
+	for (i = 0; i < 62; i++)
+		blob_append(&mystr, teststr, strlen(teststr));
+	assert(blob_buffer(&mystr) == z);
+	assert(blob_size(&mystr) == 992);
+	blob_reserve(&mystr, 10);
+	assert(blob_size(&mystr) == 992);
+	blob_reset(&mystr);
+	blob_init(&mystr, teststr, -1);
+	blob_reserve(&mystr, 100);
+	assert(strcmp(blob_str(&mystr), teststr) == 0);
+	blob_reset(&mystr);
+	/* growth policies */
+	assert(blobGrowDouble(100, 300) == 400);
+	assert(blobGrowOneHalf(100, 200) == 225);
+	assert(blobGrowPage(4000, 5000) == 8192);
+	assert(blob_set_growth(blobGrowDouble) == blobGrowDefault);
+	for (i = 0; i < 100; i++)
+		blob_append(&mystr, teststr, strlen(teststr));
+	assert(blob_size(&mystr) == 1600);
+	assert(mystr.nAlloc == 2048);
+	assert(blob_set_growth(NULL) == blobGrowDouble);
+	blob_reset(&mystr);
+	/* inline storage */
+	blob_init_inline(&mystr, zSpace, sizeof(zSpace));
+	blob_append_sql(&mystr, "SELECT %d", 1);
+	assert(blob_buffer(&mystr) == zSpace);
+	assert(strcmp(blob_str(&mystr), "SELECT 1") == 0);
+	blob_reset(&mystr);
+	assert(blob_buffer(&mystr) == zSpace);
+	assert(strcmp(blob_str(&mystr), "") == 0);
+	blob_append(&mystr, teststr, strlen(teststr));
+	blob_append(&mystr, teststr, strlen(teststr));
+	assert(blob_buffer(&mystr) != zSpace);
+	assert(mystr.xRealloc == blobReallocMalloc);
+	assert(strcmp(zSpace, teststr) == 0);
+	assert(blob_size(&mystr) == 32);
+	blob_reset(&mystr);
+	/* blob_str() of an empty blob does not allocate */
+	assert(strcmp(blob_str(&mystr), "") == 0);
+	assert(blob_buffer(&mystr) == NULL);
+	/* and its terminator may still be written */
+	z = blob_str(&mystr);
+	z[0] = 0;
+	blob_zero(&mystr);
+	assert(strcmp(blob_str(&mystr), "") == 0);
+	assert(mystr.xRealloc != blobReallocMalloc);
+	blob_reset(&mystr);
+	/* consume */
+	blob_append(&mystr, teststr, strlen(teststr));
+	assert(blob_unread(&mystr) == 16);
+	assert(memcmp(blob_peek(&mystr, 5), "black", 5) == 0);
+	assert(blob_peek(&mystr, 17) == NULL);
+	assert(blob_consume(&mystr, zSpace, 6) == 6);
+	assert(memcmp(zSpace, "black ", 6) == 0);
+	assert(blob_unread(&mystr) == 10);
+	assert(blob_consume(&mystr, NULL, 6) == 6);
+	assert(memcmp(blob_peek(&mystr, 4), "wall", 4) == 0);
+	assert(blob_consume(&mystr, zSpace, 100) == 4);
+	assert(blob_size(&mystr) == 0 && mystr.iCursor == 0);
+	for (i = 0; i < 1000; i++)
+		blob_append(&mystr, teststr, strlen(teststr));
+	assert(blob_consume(&mystr, NULL, 7000) == 7000);
+	assert(mystr.iCursor == 7000);
+	assert(blob_consume(&mystr, NULL, 1016) == 1016);
+	assert(mystr.iCursor == 0 && blob_size(&mystr) == 7984);
+	assert(memcmp(blob_peek(&mystr, 16), teststr, 16) == 0);
+	blob_reset(&mystr);
+	blob_init(&mystr, teststr, -1);
+	assert(blob_consume(&mystr, NULL, 6) == 6);
+	blob_compact(&mystr);
+	assert(blob_size(&mystr) == 10);
+	assert(strcmp(blob_str(&mystr), "sheep wall") == 0);
+	blob_reset(&mystr);
+	/* fixed-capacity fifo */
+	blob_fifo_init(&mystr, 20);
+	assert(blob_fifo_write(&mystr, teststr, 16) == 16);
+	assert(blob_fifo_write(&mystr, teststr, 16) == 4);
+	z = blob_buffer(&mystr);
+	assert(blob_consume(&mystr, zSpace, 6) == 6);
+	assert(blob_fifo_write(&mystr, "!!!!!!!!", 8) == 6);
+	assert(blob_buffer(&mystr) == z);
+	assert(blob_unread(&mystr) == 20);
+	assert(strcmp(blob_str(&mystr), "sheep wallblac!!!!!!") == 0);
+	blob_reset(&mystr);
+	/* per-thread buffer cache */
+	blob_cache_enable(4096);
+	blob_zero(&mystr);
+	blob_append(&mystr, teststr, -1);
+	assert(mystr.nAlloc == 128);
+	z = blob_buffer(&mystr);
+	blob_reset(&mystr);
+	blob_cache_stats(&st);
+	assert(st.nMalloc == 1 && st.nHit == 0 && st.nCached == 128);
+	mystr = empty_blob;
+	blob_append(&mystr, teststr, 10);
+	assert(blob_buffer(&mystr) == z);
+	for (i = 0; i < 10; i++)
+		blob_append(&mystr, teststr, -1);
+	assert(mystr.nAlloc == 512);
+	assert(strncmp(blob_str(&mystr) + 160, "sheep wall", 10) == 0);
+	blob_reset(&mystr);
+	blob_cache_stats(&st);
+	assert(st.nHit == 1 && st.nMalloc == 2 && st.nCached == 128 + 512);
+	other = empty_blob;
+	blob_append(&other, teststr, -1);
+	assert(blob_buffer(&other) == z);
+	blob_append(&mystr, teststr, -1);
+	blob_reset(&other);
+	blob_reset(&mystr);
+	blob_cache_stats(&st);
+	assert(st.nHit == 2 && st.nMalloc == 3 && st.nCached == 768);
+	/* the cap on cached bytes, and buffers too large to cache */
+	blob_reserve(&mystr, 4000);
+	assert(mystr.nAlloc == 4096);
+	blob_reset(&mystr);
+	blob_cache_stats(&st);
+	assert(st.nFree == 1 && st.nCached == 768);
+	blob_reserve(&mystr, BLOB_CACHE_MAX);
+	assert(mystr.nAlloc == BLOB_CACHE_MAX + 1);
+	blob_reset(&mystr);
+	blob_cache_enable(0);
+	blob_cache_stats(&st);
+	assert(st.nCached == 0 && st.nFree == 4);
+	blob_append(&mystr, teststr, -1);
+	assert(mystr.nAlloc == 116);
+	blob_reset(&mystr);
+#ifdef FSL_BLOB64
+	assert(sizeof(blob_size(&mystr)) == sizeof(size_t));
+#else
+	assert(sizeof(blob_size(&mystr)) == sizeof(unsigned int));
+#endif
 
 	return (0);
 }
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+int
+main(void)
+{
+	BlobChain chain;
+	Blob copy = empty_blob;
+	Blob file = empty_blob;
+	const char teststr[] = "black sheep wall";
+	const char *tmpfile = "/tmp/testme-chain-8fd3kq2l.txt";
+	FILE *in;
+	char *z;
+	int fd, i;
+
+	cez_test_start();
+	blob_chain_init(&chain, 64);
+	assert(blob_chain_size(&chain) == 0);
+	assert(strcmp(blob_str(&chain.tail), "") == 0);
+	for (i = 0; i < 100; i++) {
+		blob_chain_append(&chain, teststr, -1);
+		blob_append(&copy, teststr, -1);
+	}
+	for (i = 0; i < 100; i++) {
+		blob_chain_appendf(&chain, "%d:%q;", i, "it's");
+		blob_append_sql(&copy, "%d:%q;", i, "it's");
+	}
+	assert(blob_chain_size(&chain) == blob_size(&copy));
+	assert(chain.pFirst != NULL);
+	/* write without flattening */
+	fd = open(tmpfile, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	assert(fd >= 0);
+	assert(blob_chain_write(&chain, fd) == blob_size(&copy));
+	close(fd);
+	assert(chain.pFirst != NULL);
+	blob_chain_reset(&chain);
+	assert((in = fopen(tmpfile, "r")) != NULL);
+	blob_read_from_channel(&file, in, -1);
+	fclose(in);
+	unlink(tmpfile);
+	assert(strcmp(blob_str(&file), blob_str(&copy)) == 0);
+	blob_reset(&file);
+	/* flatten on blob_str() */
+	blob_chain_init(&chain, 0);
+	for (i = 0; i < 100000; i++)
+		blob_chain_append(&chain, teststr, -1);
+	assert(blob_chain_size(&chain) == 1600000);
+	z = blob_str(&chain.tail);
+	assert(chain.pFirst == NULL);
+	assert(blob_size(&chain.tail) == 1600000);
+	assert(strlen(z) == 1600000);
+	assert(strncmp(z + 1599984, teststr, 16) == 0);
+	/* keep appending after flattening */
+	blob_chain_appendf(&chain, "%s", teststr);
+	assert(blob_chain_size(&chain) == 1600016);
+	assert(strcmp(blob_materialize(&chain.tail) + 1600000, teststr) == 0);
+	blob_reset(&chain.tail);
+	assert(blob_chain_size(&chain) == 0);
+	assert(chain.tail.xRealloc == blobReallocChain);
+	blob_reset(&copy);
+
+	return (0);
+}
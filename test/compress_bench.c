@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Compression throughput per zlib level.  Not part of 'make test', run
+ * with 'make bench'.
+ */
+
+#include <time.h>
+
+#include "fslbase.h"
+
+#define NLINE		500000	/* lines of generated source text */
+#define NROUND		3	/* rounds timed per level */
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+static void
+bench_level(Blob *pIn, int level)
+{
+	Blob z, back;
+	double tc = 0, tu = 0, t;
+	int i;
+
+	for (i = 0; i < NROUND; i++) {
+		t = now();
+		blob_compress_level(pIn, &z, level);
+		tc += now() - t;
+		t = now();
+		blob_uncompress(&z, &back);
+		tu += now() - t;
+		if (i < NROUND - 1)
+			blob_reset(&z);
+		blob_reset(&back);
+	}
+	printf("level %d %10.2f%% %10.0f MB/s compress %10.0f MB/s "
+	    "uncompress\n", level, 100.0 * blob_size(&z) / blob_size(pIn),
+	    blob_size(pIn) * NROUND / 1e3 / tc,
+	    blob_size(pIn) * NROUND / 1e3 / tu);
+	blob_reset(&z);
+}
+
+static void
+bench_stream(Blob *pIn)
+{
+	BlobDeflate s;
+	Blob z = empty_blob;
+	Blob line;
+	double t;
+
+	t = now();
+	pIn->iCursor = 0;
+	blob_deflate_init(&s, &z, -1);
+	while (blob_line(pIn, &line))
+		blob_deflate_append(&s, blob_buffer(&line), blob_size(&line));
+	blob_deflate_finish(&s);
+	t = now() - t;
+	printf("stream  %10.2f%% %10.0f MB/s compress, line by line\n",
+	    100.0 * blob_size(&z) / blob_size(pIn), blob_size(pIn) / 1e3 / t);
+	blob_reset(&z);
+}
+
+int
+main(void)
+{
+	Blob in = empty_blob;
+	int i;
+
+	for (i = 0; i < NLINE; i++)
+		blob_append_sql(&in, "  if( p->nUsed>%d ){ blob_append(p, "
+		    "\"%x\", %d); }\n", i % 977, i * 2654435761u, i % 31);
+	printf("%lu bytes of text\n", (unsigned long)blob_size(&in));
+	for (i = 1; i <= 9; i++)
+		bench_level(&in, i);
+	bench_stream(&in);
+	blob_reset(&in);
+
+	return (0);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+int
+main(void)
+{
+	BlobDeflate z;
+	Blob in = empty_blob, out, back, bad;
+	Blob stream = empty_blob;
+	const char teststr[] = "operation cwal ";
+	unsigned char *h;
+	int i;
+
+	cez_test_start();
+	for (i = 0; i < 10000; i++)
+		blob_append_sql(&in, "%s%d\n", teststr, i);
+
+	/* one shot, Fossil size header */
+	assert(blob_compress(&in, &out) == 0);
+	assert(blob_size(&out) < blob_size(&in) / 4);
+	h = (unsigned char *)blob_buffer(&out);
+	assert((blob_size_t)((h[0] << 24) | (h[1] << 16) | (h[2] << 8) | h[3]) ==
+	    blob_size(&in));
+	assert(blob_uncompress(&out, &back) == 0);
+	assert(blob_size(&back) == blob_size(&in));
+	assert(back.nAlloc == blob_size(&in) + 1);
+	assert(memcmp(blob_buffer(&back), blob_buffer(&in),
+	    blob_size(&in)) == 0);
+	blob_reset(&back);
+
+	/* in place, every level */
+	for (i = 0; i <= 9; i++) {
+		blob_append(&back, blob_buffer(&in), blob_size(&in));
+		assert(blob_compress_level(&back, &back, i) == 0);
+		assert(blob_uncompress(&back, &back) == 0);
+		assert(strcmp(blob_str(&back), blob_str(&in)) == 0);
+		blob_reset(&back);
+	}
+
+	/* streaming, appended after existing content */
+	blob_append(&stream, "xx", 2);
+	assert(blob_deflate_init(&z, &stream, 6) == 0);
+	for (i = 0; i < 10000; i++)
+		assert(blob_deflate_append(&z, teststr, -1) == 0 &&
+		    blob_deflate_append(&z, "", 0) == 0);
+	assert(blob_deflate_finish(&z) == 0);
+	assert(memcmp(blob_buffer(&stream), "xx", 2) == 0);
+	stream.iCursor = 2;
+	blob_extract(&stream, blob_unread(&stream), &bad);
+	assert(blob_uncompress(&bad, &back) == 0);
+	assert(blob_size(&back) == 10000 * strlen(teststr));
+	assert(memcmp(blob_buffer(&back) + 15 * 9999, teststr, 15) == 0);
+	blob_reset(&back);
+	blob_reset(&stream);
+
+	/* empty input */
+	blob_zero(&bad);
+	assert(blob_compress(&bad, &back) == 0);
+	assert(blob_uncompress(&back, &back) == 0);
+	assert(blob_size(&back) == 0);
+	blob_reset(&back);
+
+	/* damaged input */
+	blob_init(&bad, "abc", 3);
+	assert(blob_uncompress(&bad, &back) == 1);
+	h[10] ^= 0x55;
+	assert(blob_uncompress(&out, &back) == 1);
+	h[10] ^= 0x55;
+	h[0] = 0x7f;
+	assert(blob_uncompress(&out, &back) == 1);
+#ifndef FSL_BLOB64
+	/* a size header past MAX_BLOB_SIZE is refused, not a panic */
+	blob_zero(&bad);
+	blob_append(&bad, "\xf0\0\0\0", 4);
+	srandom(1);
+	for (i = 0; i < 4 * 1024 * 1024; i++)
+		blob_append_char(&bad, (char)random());
+	assert(blob_uncompress(&bad, &back) == 1);
+	blob_reset(&bad);
+#endif
+
+	blob_reset(&out);
+	blob_reset(&in);
+	return (0);
+}
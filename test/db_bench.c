@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Blob buffers taken from malloc() by each db_prepare() and db_text()
+ * call.  SQL text up to DB_SQL_INLINE bytes is built inside the Stmt;
+ * longer text goes to the heap, as all of it did before.  Not part of
+ * 'make test', run with 'make bench'.
+ */
+
+#include <time.h>
+
+#include "fslbase.h"
+#include "fsldb.h"
+
+#define NCALL		100000	/* calls of each kind */
+#define NROW		100	/* rows of the test table */
+
+Global g;
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+/*
+ * Run NCALL queries through db_prepare() or db_text(), padding the SQL
+ * with nPad bytes of a string literal.
+ */
+static void
+bench_call(const char *zName, int useText, int nPad)
+{
+	BlobAccount acct;
+	Stmt q;
+	char zPad[DB_SQL_INLINE * 2];
+	u64 nAlloc;
+	double t;
+	int i;
+
+	memset(zPad, 'x', nPad);
+	zPad[nPad] = 0;
+	blob_account_get(0, &acct);
+	nAlloc = acct.nAlloc;
+	t = now();
+	for (i = 0; i < NCALL; i++) {
+		if (useText) {
+			free(db_text(0, "SELECT name FROM tbl_test"
+			    " WHERE id=%d AND name<>'%s'", i % NROW, zPad));
+		} else {
+			db_prepare(&q, "SELECT name FROM tbl_test"
+			    " WHERE id=%d AND name<>'%s'", i % NROW, zPad);
+			db_step(&q);
+			db_finalize(&q);
+		}
+	}
+	t = now() - t;
+	blob_account_get(0, &acct);
+	printf("%-24s %10.2f blob mallocs/call %10.3f us/call\n", zName,
+	    (double)(acct.nAlloc - nAlloc) / NCALL, t * 1e3 / NCALL);
+}
+
+int
+main(void)
+{
+	int i;
+
+	if (sqlite3_open(":memory:", &g.db) != SQLITE_OK)
+		return (1);
+	db_multi_exec("CREATE TABLE tbl_test(id INTEGER PRIMARY KEY,"
+	    " name TEXT)");
+	for (i = 0; i < NROW; i++)
+		db_multi_exec("INSERT INTO tbl_test(name) VALUES('user%d')", i);
+	blob_account_enable(0, 0);
+	printf("%d calls each, SQL inline up to %d bytes\n", NCALL,
+	    DB_SQL_INLINE);
+	bench_call("db_prepare short SQL", 0, 0);
+	bench_call("db_prepare long SQL", 0, DB_SQL_INLINE);
+	bench_call("db_text short SQL", 1, 0);
+	bench_call("db_text long SQL", 1, DB_SQL_INLINE);
+	sqlite3_close(g.db);
+
+	return (0);
+}
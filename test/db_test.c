@@ -50,6 +50,10 @@ main(void)
 {
 	Blob sqltrace_list = empty_blob;
 	Blob sqlblob = empty_blob;
+	BlobIntern pool = BLOB_INTERN_INITIALIZER;
+	BlobFilter filter;
+	const char *z, *zFirst = NULL;
+	char sqlbuf[64];
 	char command[256];
 	FILE *pf;
 	char *word = NULL;
@@ -81,12 +85,37 @@ main(void)
 		assert(strlen(db_column_text(&q, 1)));
 	}
 	db_finalize(&q);
+	/* repeated values are interned once */
+	db_prepare(&q, "SELECT substr(name, 1, 8), NULL FROM tbl_test");
+	while(db_step(&q)==SQLITE_ROW){
+		z = db_column_intern(&q, 0, &pool);
+		assert(zFirst == NULL || z == zFirst);
+		zFirst = z;
+		assert(db_column_intern(&q, 1, &pool) == NULL);
+	}
+	db_finalize(&q);
+	assert(strcmp(zFirst, "testuser") == 0);
+	assert(blob_intern_count(&pool) == 1);
+	blob_intern_free(&pool);
+	/* a filter built from a query */
+	blob_filter_init(&filter, 100, 10);
+	assert(db_filter_add(&filter, "SELECT name FROM tbl_test") == 4);
+	assert(blob_filter_test(&filter, "testuser3", 9));
+	blob_filter_free(&filter);
 	blob_append_sql(&sqlblob, "SELECT id FROM tbl_test");
 	db_prepare_blob(&q, &sqlblob);
 	while(db_step(&q)==SQLITE_ROW){
 		assert(db_column_int(&q, 0));
 	}
 	db_finalize(&q);
+	blob_init_inline(&sqlblob, sqlbuf, sizeof(sqlbuf));
+	blob_append_sql(&sqlblob, "SELECT name FROM tbl_test WHERE id=%d", 1);
+	db_prepare_blob(&q, &sqlblob);
+	assert(db_step(&q) == SQLITE_ROW);
+	assert(strcmp(db_column_text(&q, 0), "testuser0") == 0);
+	assert(strcmp(blob_str(&q.sql),
+	    "SELECT name FROM tbl_test WHERE id=1") == 0);
+	db_finalize(&q);
 	sqlite3_close(g.db);
 	snprintf(command, sizeof(command), "rm %s", dbname);
 	system(command);
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Delta encoding and decoding speed and size over a chain of file
+ * revisions.  Not part of 'make test', run with 'make bench'.
+ */
+
+#include <time.h>
+
+#include "fslbase.h"
+
+#define NLINE		40000	/* lines in the first revision */
+#define NREV		20	/* revisions in the chain */
+#define NEDIT		60	/* edited lines per revision */
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+/*
+ * Make a new revision of pFrom: NEDIT random lines are changed, deleted
+ * or followed by a new line, as in an ordinary commit.
+ */
+static void
+revise(Blob *pFrom, Blob *pTo, int iRev)
+{
+	Blob line;
+	int i, nLine = 0;
+	long r;
+
+	*pTo = empty_blob;
+	pFrom->iCursor = 0;
+	while (blob_line(pFrom, &line)) {
+		r = random() % (NLINE / NEDIT);
+		if (r == 0)
+			continue;
+		if (r == 1) {
+			blob_append_sql(pTo, "\tchanged(%d, %d);\n", iRev,
+			    nLine);
+		} else {
+			blob_append(pTo, blob_buffer(&line), blob_size(&line));
+		}
+		if (r == 2) {
+			for (i = 0; i < 3; i++)
+				blob_append_sql(pTo, "\tadded(%d, %d);\n",
+				    iRev, i);
+		}
+		nLine++;
+	}
+}
+
+int
+main(void)
+{
+	Blob aRev[NREV], aDelta[NREV], out;
+	double tc = 0, tu = 0, t;
+	unsigned long nTarget = 0, nDelta = 0;
+	int i;
+
+	srandom(1);
+	aRev[0] = empty_blob;
+	for (i = 0; i < NLINE; i++)
+		blob_append_sql(&aRev[0], "\tif( p->nUsed>%d ) blob_append(p, "
+		    "z, %d); /* %x */\n", i % 977, i % 31, i * 2654435761u);
+	for (i = 1; i < NREV; i++)
+		revise(&aRev[i - 1], &aRev[i], i);
+	for (i = 1; i < NREV; i++) {
+		t = now();
+		blob_delta_create(&aRev[i - 1], &aRev[i], &aDelta[i]);
+		tc += now() - t;
+		nTarget += blob_size(&aRev[i]);
+		nDelta += blob_size(&aDelta[i]);
+	}
+	for (i = 1; i < NREV; i++) {
+		t = now();
+		blob_delta_apply(&aRev[i - 1], &aDelta[i], &out);
+		tu += now() - t;
+		blob_reset(&out);
+	}
+	printf("%d revisions of %lu bytes, %d lines edited each\n", NREV - 1,
+	    (unsigned long)blob_size(&aRev[0]), NEDIT);
+	printf("delta_create %10.0f MB/s\n", nTarget / 1e3 / tc);
+	printf("delta_apply  %10.0f MB/s\n", nTarget / 1e3 / tu);
+	printf("delta size   %10.3f%% of target\n", 100.0 * nDelta / nTarget);
+	for (i = 0; i < NREV; i++) {
+		blob_reset(&aRev[i]);
+		if (i > 0)
+			blob_reset(&aDelta[i]);
+	}
+
+	return (0);
+}
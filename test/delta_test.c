@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+/*
+ * Round trip pTarget through a delta against pSource.  Return the size
+ * of the delta.
+ */
+static int
+roundtrip(Blob *pSource, Blob *pTarget)
+{
+	Blob delta, out;
+	int n;
+
+	assert(blob_delta_create(pSource, pTarget, &delta) == 0);
+	assert(delta_output_size(blob_buffer(&delta), blob_size(&delta)) ==
+	    (int)blob_size(pTarget));
+	assert(blob_delta_apply(pSource, &delta, &out) ==
+	    (int)blob_size(pTarget));
+	assert(out.nAlloc == blob_size(pTarget) + 1);
+	assert(memcmp(blob_buffer(&out), blob_buffer(pTarget),
+	    blob_size(pTarget)) == 0);
+	n = blob_size(&delta);
+	blob_reset(&out);
+	blob_reset(&delta);
+	return (n);
+}
+
+int
+main(void)
+{
+	Blob v1 = empty_blob, v2 = empty_blob, delta, out, empty, bin;
+	char *z;
+	int i, n;
+
+	cez_test_start();
+	for (i = 0; i < 2000; i++)
+		blob_append_sql(&v1, "line %d: the quick brown fox\n", i);
+	for (i = 0; i < 2000; i++) {
+		if (i % 100 == 7)
+			continue;
+		if (i % 250 == 3)
+			blob_append_sql(&v2, "inserted before %d\n", i);
+		blob_append_sql(&v2, "line %d: the %s brown fox\n", i,
+		    i % 300 == 11 ? "slow" : "quick");
+	}
+
+	/* revisions, identical files, empty files, small sources */
+	assert(roundtrip(&v1, &v2) < (int)blob_size(&v2) / 20);
+	assert(roundtrip(&v2, &v1) < (int)blob_size(&v1) / 20);
+	assert(roundtrip(&v1, &v1) < 20);
+	blob_zero(&empty);
+	assert(roundtrip(&empty, &v1) > (int)blob_size(&v1));
+	assert(roundtrip(&v1, &empty) < 10);
+	assert(roundtrip(&empty, &empty) < 10);
+
+	/* binary content */
+	bin = empty_blob;
+	srandom(1);
+	for (i = 0; i < 50000; i++)
+		blob_append_char(&bin, (char)random());
+	roundtrip(&v1, &bin);
+	n = roundtrip(&bin, &bin);
+	assert(n < 20);
+
+	/* high bytes in the checksum tail, every length mod 4 */
+	for (n = 1; n <= 4; n++) {
+		out = empty_blob;
+		for (i = 0; i < 4 * 1000 + n; i++)
+			blob_append_char(&out, (char)(0x80 | random()));
+		roundtrip(&bin, &out);
+		roundtrip(&empty, &out);
+		blob_reset(&out);
+	}
+
+	/* apply in place */
+	assert(blob_delta_create(&v1, &v2, &delta) == 0);
+	out = empty_blob;
+	blob_append(&out, blob_buffer(&v1), blob_size(&v1));
+	assert(blob_delta_apply(&out, &delta, &out) == (int)blob_size(&v2));
+	assert(strcmp(blob_str(&out), blob_str(&v2)) == 0);
+	blob_reset(&out);
+
+	/* damaged deltas */
+	z = blob_buffer(&delta);
+	for (i = 0; i < (int)blob_size(&delta) - 1; i++)
+		assert(delta_apply(blob_buffer(&v1), blob_size(&v1), z, i,
+		    blob_buffer(&v2)) == -1);
+	z[blob_size(&delta) - 2] ^= 1;
+	assert(blob_delta_apply(&v1, &delta, &out) == -1);
+	z[blob_size(&delta) - 2] ^= 1;
+	assert(blob_delta_apply(&bin, &delta, &out) == -1);
+	assert(blob_delta_apply(&v1, &delta, &out) == (int)blob_size(&v2));
+	blob_reset(&out);
+	z[0] = '!';
+	assert(blob_delta_apply(&v1, &delta, &out) == -1);
+	assert(delta_output_size("zzzzzzz\n", 8) == -1);
+	assert(delta_apply("", 0, "1\n1@0,0;", 8, blob_buffer(&v2)) == -1);
+
+	blob_reset(&delta);
+	blob_reset(&bin);
+	blob_reset(&v1);
+	blob_reset(&v2);
+	return (0);
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+static const char *b64[][2] = {
+	{ "", "" },
+	{ "f", "Zg==" },
+	{ "fo", "Zm8=" },
+	{ "foo", "Zm9v" },
+	{ "foob", "Zm9vYg==" },
+	{ "fooba", "Zm9vYmE=" },
+	{ "foobar", "Zm9vYmFy" },
+};
+
+int
+main(void)
+{
+	Blob a = empty_blob, b = empty_blob;
+	unsigned char bin[300], hex[601], back[300];
+	char *z;
+	int i, n;
+
+	cez_test_start();
+	srandom(1);
+	for (i = 0; i < (int)sizeof(bin); i++)
+		bin[i] = random();
+
+	/* hex, every length through the vector and scalar paths */
+	for (n = 0; n <= (int)sizeof(bin); n++) {
+		encode16(bin, hex, n);
+		assert(strlen((char *)hex) == 2 * (size_t)n);
+		for (i = 0; i < n; i++)
+			assert(hex[2 * i] == "0123456789abcdef"[bin[i] >> 4] &&
+			    hex[2 * i + 1] == "0123456789abcdef"[bin[i] & 15]);
+		memset(back, 0, sizeof(back));
+		assert(decode16(hex, back, 2 * n) == 0);
+		assert(memcmp(back, bin, n) == 0);
+		if (n > 0) {
+			hex[(n * 7) % (2 * n)] = 'g';
+			assert(decode16(hex, back, 2 * n) == 1);
+		}
+	}
+	assert(decode16((const unsigned char *)"ABCDEF0123456789abcdef0123456789"
+	    "ABCDEF0123456789abcdef0123456789", back, 64) == 0);
+	assert(back[0] == 0xab && back[31] == 0x89);
+	assert(decode16((const unsigned char *)"abc", back, 3) == 1);
+	assert(decode16((const unsigned char *)"a:", back, 2) == 1);
+
+	/* hex blobs */
+	blob_append(&a, "key=", 4);
+	blob_encode16(&a, (char *)bin, 200);
+	assert(blob_size(&a) == 404);
+	assert(blob_decode16(&b, blob_buffer(&a) + 4, 400) == 0);
+	assert(blob_size(&b) == 200 && memcmp(blob_buffer(&b), bin, 200) == 0);
+	assert(blob_decode16(&b, "0g", 2) == 1);
+	assert(blob_size(&b) == 200);
+	blob_reset(&a);
+	blob_reset(&b);
+
+	/* base64 test vectors from RFC 4648 */
+	for (i = 0; i < (int)(sizeof(b64) / sizeof(b64[0])); i++) {
+		blob_encode64(&a, b64[i][0], -1);
+		assert(strcmp(blob_str(&a), b64[i][1]) == 0);
+		assert(blob_decode64(&b, blob_buffer(&a), -1) == 0);
+		assert(strcmp(blob_str(&b), b64[i][0]) == 0);
+		blob_reset(&a);
+		blob_reset(&b);
+	}
+
+	/* base64, every length, with and without line breaks */
+	for (n = 0; n <= (int)sizeof(bin); n++) {
+		blob_encode64(&a, (char *)bin, n);
+		assert(blob_size(&a) == (blob_size_t)(n + 2) / 3 * 4);
+		assert(blob_decode64(&b, blob_buffer(&a), blob_size(&a)) == 0);
+		assert(blob_size(&b) == (blob_size_t)n);
+		assert(memcmp(blob_buffer(&b), bin, n) == 0);
+		blob_reset(&b);
+		z = blob_str(&a);
+		for (i = 0; z[i]; i++) {
+			blob_append_char(&b, z[i]);
+			if (i % 76 == 75)
+				blob_append(&b, "\r\n", 2);
+		}
+		blob_reset(&a);
+		while (blob_size(&b) > 0 && blob_buffer(&b)[blob_size(&b) - 1] == '=')
+			b.nUsed--;
+		assert(blob_decode64(&a, blob_buffer(&b), blob_size(&b)) == 0);
+		assert(blob_size(&a) == (blob_size_t)n);
+		assert(memcmp(blob_buffer(&a), bin, n) == 0);
+		blob_reset(&a);
+		if (n >= 40) {
+			blob_buffer(&b)[n / 2] = '*';
+			assert(blob_decode64(&a, blob_buffer(&b),
+			    blob_size(&b)) == 1);
+			assert(blob_size(&a) == 0);
+		}
+		blob_reset(&b);
+	}
+	assert(blob_decode64(&a, "Zg==Zg==", -1) == 1);
+	assert(blob_decode64(&a, "Z", -1) == 1);
+	assert(blob_decode64(&a, "Zg= =\n", -1) == 0);
+	assert(blob_size(&a) == 1);
+	blob_reset(&a);
+
+	/* %H */
+	z = mprintf("[%10H|%-6H|%#H]", "ab", "c", 3, "x\0y");
+	assert(strcmp(z, "[      6162|63    |780079]") == 0);
+	free(z);
+	blob_append_sql(&a, "%H", (char *)0);
+	assert(blob_size(&a) == 0);
+	blob_append_sql(&a, "x'%#H'", 300, (char *)bin);
+	assert(blob_size(&a) == 603);
+	assert(blob_decode16(&b, blob_buffer(&a) + 2, 600) == 0);
+	assert(memcmp(blob_buffer(&b), bin, 300) == 0);
+	blob_reset(&a);
+	blob_reset(&b);
+
+	return (0);
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Time to read many small files into blobs, one after the other with
+ * stdio or blob_read_from_file(), and in a batch.  The files are in the page cache after the first
+ * pass, so this shows the saving in system call latency only; cold
+ * caches and more cores gain more.  Not part of 'make test', run with 'make bench'.
+ */
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fslbase.h"
+
+#define NFILE		4000		/* files in the set */
+#define NLOOP		5		/* passes over the set */
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+int
+main(void)
+{
+	static char azName[NFILE][64];
+	static Blob ab[NFILE];
+	static BlobReadReq aReq[NFILE];
+	Blob content = empty_blob;
+	FILE *in;
+	double t;
+	int i, j, fd, nDepth;
+
+	blob_resize(&content, 3000);
+	memset(blob_buffer(&content), 'x', 3000);
+	for (i = 0; i < NFILE; i++) {
+		snprintf(azName[i], sizeof(azName[i]),
+		    "/tmp/bench-file-%d.txt", i);
+		fd = open(azName[i], O_WRONLY | O_CREAT | O_TRUNC, 0600);
+		blob_write_to_fd(&content, fd);
+		close(fd);
+		aReq[i].zFilename = azName[i];
+		aReq[i].pBlob = &ab[i];
+	}
+	t = now();
+	for (j = 0; j < NLOOP; j++) {
+		for (i = 0; i < NFILE; i++) {
+			in = fopen(azName[i], "r");
+			blob_read_from_channel(&ab[i], in, -1);
+			fclose(in);
+		}
+		for (i = 0; i < NFILE; i++)
+			blob_reset(&ab[i]);
+	}
+	t = now() - t;
+	printf("%-24s %8.1f us/file\n", "stdio", t * 1e3 / NFILE / NLOOP);
+	t = now();
+	for (j = 0; j < NLOOP; j++) {
+		for (i = 0; i < NFILE; i++)
+			blob_read_from_file(&ab[i], azName[i]);
+		for (i = 0; i < NFILE; i++)
+			blob_reset(&ab[i]);
+	}
+	t = now() - t;
+	printf("%-24s %8.1f us/file\n", "blob_read_from_file",
+	    t * 1e3 / NFILE / NLOOP);
+	for (nDepth = 1; nDepth <= 16; nDepth *= 4) {
+		t = now();
+		for (j = 0; j < NLOOP; j++) {
+			blob_read_batch(aReq, NFILE, nDepth, NULL, NULL);
+			for (i = 0; i < NFILE; i++)
+				blob_reset(&ab[i]);
+		}
+		t = now() - t;
+		printf("batch, depth %-11d %8.1f us/file\n", nDepth,
+		    t * 1e3 / NFILE / NLOOP);
+	}
+	for (i = 0; i < NFILE; i++)
+		unlink(azName[i]);
+	blob_reset(&content);
+
+	return (0);
+}
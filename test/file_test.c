@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+#define NFILE	40
+
+static void
+done(void *pArg, BlobReadReq *pReq)
+{
+	(*(int *)pArg)++;
+	assert(pReq->pBlob != NULL);
+}
+
+int
+main(void)
+{
+	Blob header = empty_blob, body = empty_blob, file = empty_blob;
+	Blob empty = empty_blob;
+	Blob *ap[4], ab[NFILE];
+	BlobReadReq aReq[NFILE];
+	char azName[NFILE][64];
+	const char teststr[] = "black sheep wall";
+	const char *tmpfile = "/tmp/testme-file-5kq1x0mz.txt";
+	const char *fifofile = "/tmp/testme-file-fifo";
+	char zBuf[65536];
+	struct stat st;
+	FILE *in;
+	pid_t pid;
+	int fd, pfd[2], i, status, nDone;
+	blob_ssize_t n;
+
+	cez_test_start();
+	blob_append_sql(&header, "Content-Length: %d\r\n\r\n", 16);
+	blob_append(&body, teststr, -1);
+	fd = open(tmpfile, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	assert(fd >= 0);
+	ap[0] = &header;
+	ap[1] = &empty;
+	ap[2] = &body;
+	assert(blob_writev(fd, ap, 3) == 22 + 16);
+	assert(blob_write_to_fd(&body, fd) == 16);
+	close(fd);
+	assert(blob_read_mmap(&file, tmpfile, BLOB_MMAP_SEQUENTIAL) == 54);
+	assert(strcmp(blob_str(&file), "Content-Length: 16\r\n\r\n"
+	    "black sheep wallblack sheep wall") == 0);
+	/* a mapped blob goes out as it is */
+	fd = open(tmpfile, O_WRONLY | O_APPEND);
+	assert(blob_write_to_fd(&file, fd) == 54);
+	close(fd);
+	blob_reset(&file);
+	assert((in = fopen(tmpfile, "r")) != NULL);
+	assert(blob_read_from_channel(&file, in, -1) == 108);
+	fclose(in);
+	unlink(tmpfile);
+	blob_reset(&file);
+	/* partial writes to a non-blocking pipe */
+	for (i = 0; i < 65536; i++)
+		blob_append(&file, teststr, 16);
+	assert(pipe(pfd) == 0);
+	pid = fork();
+	assert(pid >= 0);
+	if (pid == 0) {
+		close(pfd[1]);
+		i = 0;
+		while ((n = read(pfd[0], zBuf, sizeof(zBuf))) > 0) {
+			if (memcmp(zBuf, teststr + i % 16, 1) != 0)
+				_exit(1);
+			i += n;
+		}
+		_exit(i == 65536 * 16 ? 0 : 1);
+	}
+	close(pfd[0]);
+	fcntl(pfd[1], F_SETFL, O_NONBLOCK);
+	assert(blob_write_to_fd(&file, pfd[1]) == 65536 * 16);
+	close(pfd[1]);
+	assert(waitpid(pid, &status, 0) == pid);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	/* batch reads: files of all sizes, one empty and one missing */
+	for (i = 0; i < NFILE; i++) {
+		snprintf(azName[i], sizeof(azName[i]),
+		    "/tmp/testme-file-batch-%d.txt", i);
+		if (i != 7) {
+			fd = open(azName[i], O_WRONLY | O_CREAT | O_TRUNC,
+			    0600);
+			assert(fd >= 0);
+			blob_resize(&file, i * 4099);
+			memset(blob_buffer(&file), 'a' + i % 26, i * 4099);
+			assert(blob_write_to_fd(&file, fd) == i * 4099);
+			close(fd);
+		}
+		ab[i] = empty_blob;
+		aReq[i].zFilename = azName[i];
+		aReq[i].pBlob = &ab[i];
+		aReq[i].rc = -1;
+	}
+	nDone = 0;
+	assert(blob_read_batch(aReq, NFILE, 0, done, &nDone) == 1);
+	assert(nDone == NFILE);
+	for (i = 0; i < NFILE; i++) {
+		if (i == 7) {
+			assert(aReq[i].rc == ENOENT && blob_size(&ab[i]) == 0);
+			continue;
+		}
+		assert(aReq[i].rc == 0);
+		assert(blob_size(&ab[i]) == i * 4099);
+		if (i > 0) {
+			assert(blob_buffer(&ab[i])[0] == 'a' + i % 26);
+			assert(blob_buffer(&ab[i])[i * 4099 - 1] == 'a' + i % 26);
+		}
+		assert(blob_str(&ab[i])[i * 4099] == 0);
+		blob_reset(&ab[i]);
+	}
+	/* a single reader, no callback */
+	assert(blob_read_batch(aReq + 8, 4, 1, NULL, NULL) == 0);
+	for (i = 8; i < 12; i++) {
+		assert(blob_size(&ab[i]) == i * 4099);
+		blob_reset(&ab[i]);
+	}
+	/* sized reads, atomic writes and copies */
+	blob_reset(&file);
+	blob_reset(&body);
+	assert(blob_read_from_file(&file, azName[12]) == 12 * 4099);
+	assert(blob_read_from_file(&body, azName[7]) == -1);
+	assert(errno == ENOENT && blob_size(&body) == 0);
+	blob_reset(&body);
+	blob_append(&body, teststr, -1);
+	assert(blob_write_to_file(&body, azName[12]) == 16);
+	assert(blob_write_to_file(&body, "/nonexistent/dir/file") == -1);
+	blob_reset(&body);
+	assert(blob_read_from_file(&body, azName[12]) == 16);
+	assert(strcmp(blob_str(&body), teststr) == 0);
+	assert(blob_write_to_file(&file, azName[12]) == 12 * 4099);
+	blob_reset(&body);
+	assert(file_copy(azName[12], azName[7]) == 12 * 4099);
+	assert(file_copy(azName[7], azName[7]) == 12 * 4099);
+	assert(blob_read_from_file(&body, azName[7]) == 12 * 4099);
+	assert(blob_compare(&body, &file) == 0);
+	assert(file_copy("/tmp/testme-file-missing", azName[7]) == -1);
+	/* replacing a file keeps its permissions */
+	assert(chmod(azName[7], 0640) == 0);
+	assert(blob_write_to_file(&file, azName[7]) == 12 * 4099);
+	assert(stat(azName[7], &st) == 0 && (st.st_mode & 07777) == 0640);
+	assert(file_copy(azName[12], azName[7]) == 12 * 4099);
+	assert(stat(azName[7], &st) == 0 && (st.st_mode & 07777) == 0640);
+	blob_reset(&body);
+	/* a FIFO is read to end of file without seeking */
+	unlink(fifofile);
+	assert(mkfifo(fifofile, 0600) == 0);
+	pid = fork();
+	assert(pid >= 0);
+	if (pid == 0) {
+		fd = open(fifofile, O_WRONLY);
+		for (i = 0; i < 20; i++)
+			if (blob_write_to_fd(&file, fd) != 12 * 4099)
+				_exit(1);
+		_exit(0);
+	}
+	assert(blob_read_from_file(&body, fifofile) == 20 * 12 * 4099);
+	assert(waitpid(pid, &status, 0) == pid);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	assert(memcmp(blob_buffer(&body) + 19 * 12 * 4099,
+	    blob_buffer(&file), 12 * 4099) == 0);
+	assert(blob_str(&body)[20 * 12 * 4099] == 0);
+	unlink(fifofile);
+	blob_reset(&body);
+	blob_reset(&file);
+#ifndef FSL_BLOB64
+	/* sparse files too large for a blob, below and above 4GB */
+	fd = open(azName[7], O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	assert(fd >= 0);
+	assert(ftruncate(fd, 3LL << 30) == 0);
+	assert(blob_read_from_file(&body, azName[7]) == -1);
+	assert(errno == EFBIG && blob_size(&body) == 0);
+	assert(ftruncate(fd, (5LL << 30) + 16) == 0);
+	close(fd);
+	aReq[7].rc = -1;
+	assert(blob_read_batch(aReq + 7, 1, 1, NULL, NULL) == 1);
+	assert(aReq[7].rc == EFBIG && blob_size(&ab[7]) == 0);
+	blob_reset(&body);
+#endif
+	for (i = 0; i < NFILE; i++)
+		unlink(azName[i]);
+	blob_reset(&file);
+	blob_reset(&header);
+	blob_reset(&body);
+
+	return (0);
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * False positive rate and speed of BlobFilter at a few sizes, with keys
+ * like artifact hashes.  Not part of 'make test', run with 'make bench'.
+ */
+
+#include <time.h>
+
+#include "fslbase.h"
+
+#define NKEY		1000000		/* keys added */
+#define NPROBE		1000000		/* keys that were not added */
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+int
+main(void)
+{
+	static const unsigned int aBits[] = { 8, 10, 12, 16 };
+	BlobFilter f;
+	char *azKey;
+	double tAdd, tHit, tMiss;
+	unsigned int b;
+	int i, n;
+
+	azKey = malloc((size_t)(NKEY + NPROBE) * 48);
+	for (i = 0; i < NKEY + NPROBE; i++)
+		snprintf(azKey + (size_t)i * 48, 48, "%08x%08x%08x%08x%08x",
+		    i * 2654435761u, i, ~i, i * 40503u, i ^ 0x5bd1e995);
+	printf("%d keys   fp rate    add ns   hit ns  miss ns\n", NKEY);
+	for (b = 0; b < sizeof(aBits) / sizeof(aBits[0]); b++) {
+		blob_filter_init(&f, NKEY, aBits[b]);
+		tAdd = now();
+		for (i = 0; i < NKEY; i++)
+			blob_filter_add(&f, azKey + (size_t)i * 48, 40);
+		tAdd = now() - tAdd;
+		tHit = now();
+		for (i = n = 0; i < NKEY; i++)
+			n += blob_filter_test(&f, azKey + (size_t)i * 48, 40);
+		tHit = now() - tHit;
+		if (n != NKEY)
+			printf("false negatives!\n");
+		tMiss = now();
+		for (i = n = 0; i < NPROBE; i++)
+			n += blob_filter_test(&f,
+			    azKey + (size_t)(NKEY + i) * 48, 40);
+		tMiss = now() - tMiss;
+		printf("%2u bits/key %7.3f%% %8.1f %8.1f %8.1f\n", aBits[b],
+		    100.0 * n / NPROBE, tAdd * 1e6 / NKEY, tHit * 1e6 / NKEY,
+		    tMiss * 1e6 / NPROBE);
+		blob_filter_free(&f);
+	}
+	free(azKey);
+
+	return (0);
+}
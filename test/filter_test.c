@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+#define NKEY	10000
+
+int
+main(void)
+{
+	BlobFilter f, g;
+	Blob saved = empty_blob, key = empty_blob;
+	char zBuf[48];
+	int i, nFalse;
+
+	cez_test_start();
+	blob_filter_init(&f, NKEY, 10);
+	assert(f.nHash == 7 && f.nItem == 0);
+	assert(blob_filter_test(&f, "anything", 8) == 0);
+	for (i = 0; i < NKEY; i++) {
+		snprintf(zBuf, sizeof(zBuf), "%040x", i * 2654435761u);
+		blob_filter_add(&f, zBuf, 40);
+	}
+	assert(f.nItem == NKEY);
+	/* no false negatives, about 1% false positives */
+	for (i = 0; i < NKEY; i++) {
+		snprintf(zBuf, sizeof(zBuf), "%040x", i * 2654435761u);
+		assert(blob_filter_test(&f, zBuf, 40));
+	}
+	for (i = nFalse = 0; i < 10 * NKEY; i++) {
+		snprintf(zBuf, sizeof(zBuf), "miss-%d", i);
+		nFalse += blob_filter_test(&f, zBuf, strlen(zBuf));
+	}
+	assert(nFalse < NKEY / 5);
+	/* blobs and the empty string */
+	blob_append(&key, "trunk", -1);
+	assert(blob_filter_test_blob(&f, &key) == 0 || nFalse > 0);
+	blob_filter_add_blob(&f, &key);
+	assert(blob_filter_test_blob(&f, &key));
+	blob_filter_add(&f, "", 0);
+	assert(blob_filter_test(&f, "", 0));
+	/* save, load back, and keep adding */
+	blob_append(&saved, "prefix", 6);
+	blob_filter_save(&f, &saved);
+	assert(blob_size(&saved) == 6 + 32 + f.nBlock * 64);
+	assert(blob_filter_load(&g, blob_buffer(&saved), 6) == 0);
+	assert(blob_filter_load(&g, blob_buffer(&saved) + 6,
+	    blob_size(&saved) - 7) == 0);
+	assert(blob_filter_load(&g, blob_buffer(&saved) + 6,
+	    blob_size(&saved) - 6) == blob_size(&saved) - 6);
+	assert(g.nBlock == f.nBlock && g.nHash == f.nHash);
+	assert(g.nItem == NKEY + 2);
+	assert(memcmp(g.aBit, f.aBit, f.nBlock * 64) == 0);
+	assert(blob_filter_test_blob(&g, &key));
+	assert(blob_filter_test(&g, "branch", 6) ==
+	    blob_filter_test(&f, "branch", 6));
+	blob_filter_add(&g, "branch", 6);
+	assert(blob_filter_test(&g, "branch", 6));
+	blob_filter_free(&g);
+	blob_buffer(&saved)[6] = 'X';
+	assert(blob_filter_load(&g, blob_buffer(&saved) + 6,
+	    blob_size(&saved) - 6) == 0);
+	blob_filter_free(&f);
+	/* a tiny filter still works */
+	blob_filter_init(&f, 0, 0);
+	assert(f.nBlock == 1 && f.nHash == 1);
+	blob_filter_add(&f, "x", 1);
+	assert(blob_filter_test(&f, "x", 1));
+	blob_filter_free(&f);
+	blob_reset(&saved);
+	blob_reset(&key);
+
+	return (0);
+}
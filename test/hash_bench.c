@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * Throughput of the artifact hashes over one large blob and over many
+ * small ones in a batch.  Build the library with 'make -DNOSIMD' to
+ * compare with the portable SHA1.  Not part of 'make test', run with
+ * 'make bench'.
+ */
+
+#include <time.h>
+
+#include "fslbase.h"
+
+#define NBYTE		(64 << 20)	/* size of the large blob */
+#define NBLOB		4096		/* blobs in the batch */
+#define NSMALL		(16 << 10)	/* size of each of them */
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+int
+main(void)
+{
+	static Blob ab[NBLOB], aOut[NBLOB];
+	static Blob *apIn[NBLOB];
+	Blob big = empty_blob, out = empty_blob;
+	const char *azAlg[] = { "sha1", "sha3-256" };
+	double t;
+	int i, j, nThread;
+
+	blob_resize(&big, NBYTE);
+	for (i = 0; i < NBYTE; i++)
+		blob_buffer(&big)[i] = (char)(i * 7 + (i >> 9));
+	for (i = 0; i < NBLOB; i++) {
+		blob_init(&ab[i], blob_buffer(&big) + i * 997, NSMALL);
+		apIn[i] = &ab[i];
+		aOut[i] = empty_blob;
+	}
+	for (j = HNAME_ALG_SHA1; j <= HNAME_ALG_K256; j++) {
+		t = now();
+		hname_hash(&big, j, &out);
+		t = now() - t;
+		blob_reset(&out);
+		printf("%-8s one blob          %8.0f MB/s\n", azAlg[j],
+		    NBYTE / 1e3 / t);
+		for (nThread = 1; nThread <= 8; nThread *= 2) {
+			t = now();
+			hname_hash_batch(apIn, aOut, NBLOB, j, nThread);
+			t = now() - t;
+			for (i = 0; i < NBLOB; i++)
+				blob_reset(&aOut[i]);
+			printf("%-8s batch, %d threads %8.0f MB/s\n", azAlg[j],
+			    nThread, (double)NBLOB * NSMALL / 1e3 / t);
+		}
+	}
+	for (i = 0; i < NBLOB; i++)
+		blob_reset(&ab[i]);
+	blob_reset(&big);
+
+	return (0);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+#define NBLOB	50
+
+static void
+check(const char *zIn, int n, const char *zSha1, const char *zSha3)
+{
+	Blob in, out = empty_blob;
+
+	blob_init(&in, zIn, n);
+	assert(sha1sum_blob(&in, &out) == 0);
+	assert(strcmp(blob_str(&out), zSha1) == 0);
+	blob_reset(&out);
+	sha3sum_blob(&in, 256, &out);
+	assert(strcmp(blob_str(&out), zSha3) == 0);
+	blob_reset(&out);
+	blob_reset(&in);
+}
+
+int
+main(void)
+{
+	Blob a = empty_blob, b = empty_blob, ab[NBLOB], *apIn[NBLOB];
+	Blob aOut[NBLOB];
+	int i, j;
+
+	cez_test_start();
+	check("", 0,
+	    "da39a3ee5e6b4b0d3255bfef95601890afd80709",
+	    "a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a");
+	check("abc", 3,
+	    "a9993e364706816aba3e25717850c26c9cd0d89d",
+	    "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532");
+	check("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 56,
+	    "84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+	    "41c0dba2a9d6240849100376a8235e2c82e1b9998a999e21db32dd97496d3376");
+	/* one million 'a', and the lengths around each block boundary */
+	blob_resize(&a, 1000000);
+	memset(blob_buffer(&a), 'a', 1000000);
+	assert(sha1sum_blob(&a, &b) == 0);
+	assert(strcmp(blob_str(&b),
+	    "34aa973cd4c4daa4f61eeb2bdbad27316534016f") == 0);
+	blob_reset(&b);
+	sha3sum_blob(&a, 256, &b);
+	assert(strcmp(blob_str(&b),
+	    "5c8875ae474a3634ba4fd55ec85bffd661f32aca75c6d699d0cdcb6c115891c1")
+	    == 0);
+	blob_reset(&b);
+	sha3sum_blob(&a, 512, &b);
+	assert(blob_size(&b) == 128);
+	assert(strncmp(blob_str(&b), "3c3a876da14034ab60627c077bb98f7e", 32)
+	    == 0);
+	blob_reset(&b);
+	/* the hash may replace the content */
+	blob_resize(&a, 3);
+	assert(hname_hash(&a, HNAME_ALG_SHA1, &a) == 0);
+	assert(strcmp(blob_str(&a),
+	    "7e240de74fb1ed08fa08d38063f6a6a91462a815") == 0);
+	assert(hname_hash(&a, 7, &b) == 1);
+	blob_reset(&a);
+	/* a batch gives the same hashes as one at a time */
+	for (i = 0; i < NBLOB; i++) {
+		ab[i] = empty_blob;
+		for (j = 0; j < i * 37; j++)
+			blob_append_char(&ab[i], 'a' + (i + j) % 26);
+		apIn[i] = &ab[i];
+		aOut[i] = empty_blob;
+	}
+	for (j = HNAME_ALG_SHA1; j <= HNAME_ALG_K256; j++) {
+		assert(hname_hash_batch(apIn, aOut, NBLOB, j, 0) == 0);
+		for (i = 0; i < NBLOB; i++) {
+			hname_hash(&ab[i], j, &b);
+			assert(blob_compare(&b, &aOut[i]) == 0);
+			assert(blob_size(&b) == (j == HNAME_ALG_SHA1 ? 40 : 64));
+			blob_reset(&b);
+			blob_reset(&aOut[i]);
+		}
+	}
+	assert(hname_hash_batch(apIn, aOut, NBLOB, 7, 0) == 1);
+	for (i = 0; i < NBLOB; i++)
+		blob_reset(&ab[i]);
+
+	return (0);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+int
+main(void)
+{
+	BlobIntern pool = BLOB_INTERN_INITIALIZER;
+	Blob b = empty_blob;
+	const char *z1, *z2, *z3, *zEmpty, *az[1000];
+	char zBuf[32];
+	int i;
+
+	cez_test_start();
+	/* equal content, equal pointers */
+	z1 = blob_intern(&pool, "trunk", -1);
+	memcpy(zBuf, "trunk", 6);
+	z2 = blob_intern(&pool, zBuf, 5);
+	assert(z1 == z2 && z1 != zBuf);
+	zBuf[0] = 'T';
+	assert(strcmp(z1, "trunk") == 0);
+	z3 = blob_intern(&pool, "trunk-2", 5);
+	assert(z3 == z1);
+	z3 = blob_intern(&pool, "trunk-2", -1);
+	assert(z3 != z1 && strcmp(z3, "trunk-2") == 0);
+	/* length and hash are kept */
+	assert(blob_intern_len(z1) == 5 && blob_intern_len(z3) == 7);
+	assert(blob_intern_hash(z1) == blob_map_hash("trunk", 5));
+	/* blobs, embedded nul bytes and the empty string */
+	blob_append(&b, "text/plain", -1);
+	assert(blob_intern_blob(&pool, &b) == blob_intern(&pool,
+	    "text/plain", -1));
+	blob_reset(&b);
+	zEmpty = blob_intern_blob(&pool, &b);
+	assert(zEmpty[0] == 0 && blob_intern_len(zEmpty) == 0);
+	assert(blob_intern(&pool, "", 0) == zEmpty);
+	z1 = blob_intern(&pool, "a\0b", 3);
+	assert(blob_intern_len(z1) == 3 && memcmp(z1, "a\0b", 4) == 0);
+	assert(blob_intern(&pool, "a", -1) != z1);
+	assert(blob_intern_count(&pool) == 6);
+	/* pointers stay valid as the pool grows */
+	for (i = 0; i < 1000; i++) {
+		snprintf(zBuf, sizeof(zBuf), "user%d", i % 100);
+		az[i] = blob_intern(&pool, zBuf, -1);
+		assert(i < 100 || az[i] == az[i - 100]);
+	}
+	assert(blob_intern_count(&pool) == 106);
+	for (i = 0; i < 100; i++) {
+		snprintf(zBuf, sizeof(zBuf), "user%d", i);
+		assert(strcmp(az[i], zBuf) == 0);
+	}
+	blob_intern_free(&pool);
+	assert(blob_intern_count(&pool) == 0);
+	blob_intern_init(&pool);
+	assert(strcmp(blob_intern(&pool, "again", -1), "again") == 0);
+	blob_intern_free(&pool);
+
+	return (0);
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/*
+ * BlobMap against a chained hash table with one malloc()ed node per
+ * entry, as ad-hoc caches are often written.  Both use blob_map_hash(),
+ * so the difference is the layout.  Not part of 'make test', run with
+ * 'make bench'.
+ */
+
+#include <time.h>
+
+#include "fslbase.h"
+
+typedef struct Node Node;
+struct Node {
+	Node		*pNext;
+	const char	*zKey;
+	unsigned int	 nKey;
+	void		*pValue;
+};
+
+typedef struct {
+	Node		**apBucket;
+	u64		  nBucket;
+	u64		  nUsed;
+} Chain;
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+static Node **
+chain_slot(Chain *p, const char *zKey, unsigned int nKey)
+{
+	Node **pp;
+
+	pp = &p->apBucket[blob_map_hash(zKey, nKey) & (p->nBucket - 1)];
+	while (*pp && ((*pp)->nKey != nKey ||
+	    memcmp((*pp)->zKey, zKey, nKey) != 0))
+		pp = &(*pp)->pNext;
+	return (pp);
+}
+
+static void
+chain_insert(Chain *p, const char *zKey, unsigned int nKey, void *pValue)
+{
+	Node **pp, *pN, *pNext, **apOld;
+	u64 i, nOld;
+
+	if (p->nUsed >= p->nBucket) {
+		apOld = p->apBucket;
+		nOld = p->nBucket;
+		p->nBucket = nOld ? nOld * 2 : 16;
+		p->apBucket = calloc(p->nBucket, sizeof(Node *));
+		for (i = 0; i < nOld; i++) {
+			for (pN = apOld[i]; pN; pN = pNext) {
+				pNext = pN->pNext;
+				pp = &p->apBucket[blob_map_hash(pN->zKey,
+				    pN->nKey) & (p->nBucket - 1)];
+				pN->pNext = *pp;
+				*pp = pN;
+			}
+		}
+		free(apOld);
+	}
+	pp = chain_slot(p, zKey, nKey);
+	if (*pp == NULL) {
+		*pp = pN = malloc(sizeof(*pN));
+		pN->pNext = NULL;
+		pN->zKey = zKey;
+		pN->nKey = nKey;
+		p->nUsed++;
+	}
+	(*pp)->pValue = pValue;
+}
+
+static void
+chain_erase(Chain *p, const char *zKey, unsigned int nKey)
+{
+	Node **pp = chain_slot(p, zKey, nKey), *pN = *pp;
+
+	if (pN) {
+		*pp = pN->pNext;
+		free(pN);
+		p->nUsed--;
+	}
+}
+
+static void
+report(const char *zName, const char *zOp, double t, int n)
+{
+	printf("%-10s %-8s %8.1f ns/op\n", zName, zOp, t * 1e6 / n);
+}
+
+static void
+bench(int n)
+{
+	BlobMap map = BLOB_MAP_INITIALIZER;
+	BlobMapEntry *pE;
+	Chain chain = { NULL, 0, 0 };
+	char *azKey, *zMiss;
+	unsigned int *anKey, *aOrder, u;
+	double t;
+	int i, j, nHit;
+
+	/* keys like artifact hashes, and as many keys that are absent */
+	azKey = malloc((size_t)n * 2 * 48);
+	anKey = malloc((size_t)n * 2 * sizeof(*anKey));
+	for (i = 0; i < 2 * n; i++)
+		anKey[i] = snprintf(azKey + (size_t)i * 48, 48,
+		    "%08x%08x%08x", i * 2654435761u, i, ~i);
+	zMiss = azKey + (size_t)n * 48;
+	/* look keys up in a random order, not the order of insertion */
+	aOrder = malloc((size_t)n * sizeof(*aOrder));
+	for (i = 0; i < n; i++)
+		aOrder[i] = i;
+	for (i = n - 1; i > 0; i--) {
+		j = (int)(((u64)i * 2654435761u + 12345) % (i + 1));
+		u = aOrder[i];
+		aOrder[i] = aOrder[j];
+		aOrder[j] = u;
+	}
+	printf("%d entries\n", n);
+
+	t = now();
+	for (i = 0; i < n; i++) {
+		pE = blob_map_insert(&map, azKey + (size_t)i * 48, anKey[i],
+		    NULL);
+		pE->pValue = &anKey[i];
+	}
+	report("BlobMap", "insert", now() - t, n);
+	t = now();
+	for (i = 0; i < n; i++)
+		chain_insert(&chain, azKey + (size_t)i * 48, anKey[i],
+		    &anKey[i]);
+	report("chained", "insert", now() - t, n);
+
+	t = now();
+	for (i = nHit = 0; i < n; i++)
+		nHit += blob_map_find(&map, azKey + (size_t)aOrder[i] * 48,
+		    anKey[aOrder[i]]) != NULL;
+	report("BlobMap", "hit", now() - t, n);
+	t = now();
+	for (i = 0; i < n; i++)
+		nHit += *chain_slot(&chain, azKey + (size_t)aOrder[i] * 48,
+		    anKey[aOrder[i]]) != NULL;
+	report("chained", "hit", now() - t, n);
+
+	t = now();
+	for (i = 0; i < n; i++)
+		nHit += blob_map_find(&map, zMiss + (size_t)i * 48,
+		    anKey[n + i]) != NULL;
+	report("BlobMap", "miss", now() - t, n);
+	t = now();
+	for (i = 0; i < n; i++)
+		nHit += *chain_slot(&chain, zMiss + (size_t)i * 48,
+		    anKey[n + i]) != NULL;
+	report("chained", "miss", now() - t, n);
+	if (nHit != 2 * n)
+		printf("wrong number of hits: %d\n", nHit);
+
+	t = now();
+	for (i = 0; i < n; i++)
+		blob_map_erase(&map, azKey + (size_t)aOrder[i] * 48,
+		    anKey[aOrder[i]]);
+	report("BlobMap", "erase", now() - t, n);
+	t = now();
+	for (i = 0; i < n; i++)
+		chain_erase(&chain, azKey + (size_t)aOrder[i] * 48,
+		    anKey[aOrder[i]]);
+	report("chained", "erase", now() - t, n);
+
+	blob_map_free(&map);
+	free(chain.apBucket);
+	free(aOrder);
+	free(anKey);
+	free(azKey);
+}
+
+int
+main(void)
+{
+	bench(1000000);
+	bench(4000000);
+
+	return (0);
+}
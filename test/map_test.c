@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+#define NKEY	20000
+
+int
+main(void)
+{
+	BlobMap map = BLOB_MAP_INITIALIZER;
+	BlobMapEntry *pE;
+	Blob key = empty_blob;
+	static char azKey[NKEY][16];
+	static int aSeen[NKEY];
+	int i, j, n, bNew;
+
+	cez_test_start();
+	assert(blob_map_find(&map, "x", 1) == NULL);
+	assert(blob_map_next(&map, NULL) == NULL);
+	assert(blob_map_erase(&map, "x", 1) == 0);
+	for (i = 0; i < NKEY; i++)
+		snprintf(azKey[i], sizeof(azKey[i]), "key-%d", i);
+	/* insert, find, and insert again */
+	for (i = 0; i < NKEY; i++) {
+		pE = blob_map_insert(&map, azKey[i], strlen(azKey[i]), &bNew);
+		assert(bNew && pE->pValue == NULL);
+		pE->pValue = azKey[i];
+	}
+	assert(blob_map_count(&map) == NKEY);
+	for (i = 0; i < NKEY; i++) {
+		pE = blob_map_find(&map, azKey[i], strlen(azKey[i]));
+		assert(pE != NULL && pE->pValue == azKey[i]);
+		pE = blob_map_insert(&map, azKey[i], strlen(azKey[i]), &bNew);
+		assert(!bNew && pE->pValue == azKey[i]);
+	}
+	assert(blob_map_find(&map, "key-", 4) == NULL);
+	assert(blob_map_find(&map, "key-12", 5) != NULL);
+	assert(blob_map_find(&map, "key-200000", 10) == NULL);
+	/* keys are compared by content, and may be empty */
+	blob_append(&key, "key-78", -1);
+	pE = blob_map_find_blob(&map, &key);
+	assert(pE != NULL && pE->pValue == azKey[78]);
+	pE = blob_map_insert(&map, "", 0, &bNew);
+	assert(bNew && blob_map_count(&map) == NKEY + 1);
+	assert(blob_map_erase(&map, "", 0) == 1);
+	/* erase the odd keys while iterating */
+	n = 0;
+	for (pE = blob_map_next(&map, NULL); pE; pE = blob_map_next(&map, pE)) {
+		i = atoi(pE->zKey + 4);
+		assert(!aSeen[i]);
+		aSeen[i] = 1;
+		n++;
+		if (i % 2)
+			blob_map_erase_entry(&map, pE);
+	}
+	assert(n == NKEY && blob_map_count(&map) == NKEY / 2);
+	for (i = 0; i < NKEY; i++)
+		assert((blob_map_find(&map, azKey[i], strlen(azKey[i])) ==
+		    NULL) == (i % 2));
+	assert(blob_map_erase_blob(&map, &key) == 1);
+	assert(blob_map_erase_blob(&map, &key) == 0);
+	/* churn fills the table with deleted slots, which must be reused */
+	for (j = 0; j < 50; j++) {
+		for (i = 1; i < NKEY; i += 2)
+			blob_map_insert(&map, azKey[i], strlen(azKey[i]), NULL);
+		for (i = 1; i < NKEY; i += 2)
+			assert(blob_map_erase(&map, azKey[i],
+			    strlen(azKey[i])) == 1);
+	}
+	assert(blob_map_count(&map) == NKEY / 2 - 1);
+	assert(map.nSlot <= 4 * NKEY);
+	blob_map_free(&map);
+	/* a reserved map does not rehash */
+	blob_map_reserve(&map, NKEY);
+	n = map.nSlot;
+	for (i = 0; i < NKEY; i++)
+		blob_map_insert(&map, azKey[i], strlen(azKey[i]), NULL);
+	assert(map.nSlot == n);
+	blob_map_free(&map);
+	assert(blob_map_hash("abc", 3) != blob_map_hash("abd", 3));
+	assert(blob_map_hash("abc", 3) == blob_map_hash("abcd", 3));
+	blob_reset(&key);
+
+	return (0);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <unistd.h>
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+int
+main(void)
+{
+	Blob content = empty_blob;
+	const char teststr[] = "black sheep wall";
+	const char *tmpfile = "/tmp/testme-mmap-q0v7dh3s.txt";
+	FILE *out;
+	char *z;
+	int i;
+
+	cez_test_start();
+	assert((out = fopen(tmpfile, "w")) != NULL);
+	fputs(teststr, out);
+	fclose(out);
+	assert(blob_read_mmap(&content, tmpfile, BLOB_MMAP_SEQUENTIAL) == 16);
+	assert(content.xRealloc == blobReallocMmap);
+	assert(memcmp(blob_buffer(&content), teststr, 16) == 0);
+	/* the terminator fits in the last page, no copy */
+	z = blob_str(&content);
+	assert(strcmp(z, teststr) == 0);
+	assert(content.xRealloc == blobReallocMmap);
+	blob_mmap_advise(&content, BLOB_MMAP_RANDOM);
+	/* the first change copies the content */
+	blob_append(&content, " 2", 2);
+	assert(content.xRealloc == blobReallocMalloc);
+	assert(strcmp(blob_str(&content), "black sheep wall 2") == 0);
+	blob_reset(&content);
+	/* reset unmaps */
+	assert(blob_read_mmap(&content, tmpfile, BLOB_MMAP_NORMAL) == 16);
+	blob_reset(&content);
+	assert(blob_size(&content) == 0);
+	assert(content.xRealloc == blobReallocMalloc);
+	/* consuming advances past the mapping instead of moving it */
+	assert((out = fopen(tmpfile, "w")) != NULL);
+	for (i = 0; i < 10000; i++)
+		fputc('a' + i % 26, out);
+	fclose(out);
+	assert(blob_read_mmap(&content, tmpfile, BLOB_MMAP_NORMAL) == 10000);
+	z = blob_buffer(&content);
+	assert(blob_consume(&content, NULL, 5000) == 5000);
+	assert(blob_buffer(&content) == z + 5000);
+	assert(content.xRealloc == blobReallocMmap);
+	assert(blob_buffer(&content)[0] == 'a' + 5000 % 26);
+	assert(blob_consume(&content, NULL, 4990) == 4990);
+	assert(blob_buffer(&content)[0] == 'a' + 9990 % 26);
+	assert(blob_size(&content) == 10);
+	blob_reset(&content);
+	assert(blob_read_mmap(&content, tmpfile, BLOB_MMAP_NORMAL) == 10000);
+	assert(blob_buffer(&content)[0] == 'a');
+	assert(blob_consume(&content, NULL, 10000) == 10000);
+	assert(blob_size(&content) == 0);
+	blob_reset(&content);
+	/* empty and missing files */
+	assert((out = fopen(tmpfile, "w")) != NULL);
+	fclose(out);
+	assert(blob_read_mmap(&content, tmpfile, BLOB_MMAP_NORMAL) == 0);
+	assert(strcmp(blob_str(&content), "") == 0);
+	blob_reset(&content);
+#ifndef FSL_BLOB64
+	/* a sparse file too large for a blob */
+	assert(truncate(tmpfile, 3LL << 30) == 0);
+	assert(blob_read_mmap(&content, tmpfile, BLOB_MMAP_NORMAL) == -1);
+	assert(errno == EFBIG && blob_size(&content) == 0);
+#endif
+	unlink(tmpfile);
+	assert(blob_read_mmap(&content, tmpfile, BLOB_MMAP_NORMAL) == -1);
+	assert(blob_size(&content) == 0);
+
+	return (0);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+/*
+ * vxprintf() on the kind of formats db_prepare() and db_multi_exec()
+ * see, with the cache of compiled formats off and on.  The output of
+ * the two runs is compared.  Not part of 'make test', run with
+ * 'make bench'.
+ */
+
+#include <time.h>
+
+#include "fslbase.h"
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+static void
+run(Blob *pOut, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		blob_append_sql(pOut, "SELECT rid FROM blob WHERE uuid=%Q",
+		    "6f4c8d0b5e2a17c39a0d4e6b8f1c2a3d4e5f6a7b");
+		blob_append_sql(pOut,
+		    "INSERT INTO event(type,mtime,objid,user,comment)"
+		    "VALUES('ci',%.17g,%d,%Q,%Q)", 2461234.5, i, "koue",
+		    "Fix the build");
+		blob_append_sql(pOut,
+		    "UPDATE vfile SET chnged=%d, mrid=%d WHERE id=%d",
+		    i & 1, i, i + 7);
+		blob_append_sql(pOut,
+		    "DELETE FROM tagxref WHERE tagid=%d AND rid=%lld",
+		    i % 13, (long long)i * 1000);
+		blob_append_sql(pOut,
+		    "REPLACE INTO config(name,value,mtime) VALUES(%Q,%Q,now())",
+		    "project-name", "libfsl");
+	}
+}
+
+static double
+bench(Blob *pOut, int n, int bCache)
+{
+	double t;
+
+	vxprintf_cache_enable(bCache);
+	blob_resize(pOut, 0);
+	run(pOut, 1);
+	blob_resize(pOut, 0);
+	t = now();
+	run(pOut, n);
+	t = now() - t;
+	vxprintf_cache_enable(0);
+	return (t);
+}
+
+int
+main(int argc, char **argv)
+{
+	Blob a = BLOB_INITIALIZER, b = BLOB_INITIALIZER;
+	double tOff, tOn;
+	int n = 200000;
+
+	if (argc > 1)
+		n = atoi(argv[1]);
+	tOff = bench(&a, n, 0);
+	tOn = bench(&b, n, 1);
+	printf("%d x 5 statements, %llu bytes\n", n,
+	    (unsigned long long)blob_size(&a));
+	printf("%-10s %8.1f ns/call\n", "parse", tOff * 1e6 / (5.0 * n));
+	printf("%-10s %8.1f ns/call\n", "compiled", tOn * 1e6 / (5.0 * n));
+	printf("speedup    %8.2fx\n", tOff / tOn);
+	if (blob_compare(&a, &b) != 0)
+		printf("output differs\n");
+	blob_reset(&a);
+	blob_reset(&b);
+	return (0);
+}
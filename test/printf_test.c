@@ -68,8 +68,119 @@ static const array fmt[] = {
 	{ "%%", "black sheep wall", "%" },
 //	{ "%p", "black sheep wall", "black sheep wall" },
 	{ "%/", "black sheep wall", "black sheep wall" },
+	{ "%H", "black sheep wall", "626c61636b2073686565702077616c6c" },
 };
 
+static char *
+sql(const char *zFmt)
+{
+	return (mprintf(zFmt, 42, -7, "it's", 1234567LL, 3.25, "x", 5, 2, "abcdef"));
+}
+
+static void
+test_cache(void)
+{
+	static const char *azFmt[] = {
+		"SELECT %d, %d, %Q, %lld, %.2f FROM t WHERE x=%Q AND %*.*s",
+		"%5d|%-5d|%q|%,lld|%e|%s|%%|%-*.*s",
+		"INSERT INTO t(a) VALUES(%+d)%#x%q%lld%g%.1s%i%d%s tail",
+		"no conversions at all",
+		"",
+		"%d %d %s %lld %f %s %d %d %",
+	};
+	char buf[64];
+	char *zWant, *zGot;
+	int i, nCached;
+
+	for (i = 0; i < sizeof(azFmt)/sizeof(azFmt[0]); i++) {
+		zWant = sql(azFmt[i]);
+		vxprintf_cache_enable(1);
+		zGot = sql(azFmt[i]);
+		assert(strcmp(zWant, zGot) == 0);
+		free(zGot);
+		/* The second call runs from the cache */
+		zGot = sql(azFmt[i]);
+		vxprintf_cache_enable(0);
+		assert(strcmp(zWant, zGot) == 0);
+		free(zGot);
+		free(zWant);
+	}
+	/* A format with an error is interpreted, not cached */
+	nCached = vxprintf_cache_count();
+	assert(nCached == sizeof(azFmt)/sizeof(azFmt[0]) - 1);
+
+	/* A reused buffer does not pick up the program of its old text */
+	vxprintf_cache_enable(1);
+	memcpy(buf, "a=%d", 5);
+	zGot = mprintf(buf, 1);
+	assert(strcmp(zGot, "a=1") == 0);
+	free(zGot);
+	memcpy(buf, "b=%s!", 6);
+	zGot = mprintf(buf, "two");
+	assert(strcmp(zGot, "b=two!") == 0);
+	free(zGot);
+	vxprintf_cache_enable(0);
+}
+
+static void
+test_radix(void)
+{
+	static const char *azFmt[] = {
+		"%lld", "%5lld", "%-7lld|", "%020lld", "%.3lld", "%+lld",
+		"% lld", "%llu", "%llx", "%llX", "%#llx", "%#llo", "%llo",
+		"%12.8llx", "%-#10llX|", "%+08lld", "%.25lld",
+	};
+	static const long long aVal[] = {
+		0, 1, -1, 7, 9, 10, 11, 99, 100, 101, 999, 1000, 4095, 4096,
+		65535, 99999, 100000, 2147483647LL, -2147483647LL - 1,
+		4294967295LL, 4294967296LL, 999999999999LL, 1000000000000LL,
+		9223372036854775807LL, -9223372036854775807LL - 1,
+		-123456789012345LL, 0x0123456789abcdefLL,
+	};
+	char zWant[100], *z;
+	long long v;
+	int i, j, k;
+
+	for (i = 0; i < sizeof(azFmt)/sizeof(azFmt[0]); i++) {
+		for (j = 0; j < sizeof(aVal)/sizeof(aVal[0]); j++) {
+			snprintf(zWant, sizeof(zWant), azFmt[i], aVal[j]);
+			z = mprintf(azFmt[i], aVal[j]);
+			assert(strcmp(z, zWant) == 0);
+			free(z);
+		}
+	}
+	/* Every power of ten and its neighbours, as int and as long long */
+	for (v = 1, k = 0; k < 19; k++, v = (unsigned long long)v * 10) {
+		for (j = -1; j <= 1; j++) {
+			snprintf(zWant, sizeof(zWant), "%lld %llu %llx",
+			    v + j, (unsigned long long)v + j,
+			    (unsigned long long)v + j);
+			z = mprintf("%lld %llu %llx", v + j,
+			    (unsigned long long)v + j,
+			    (unsigned long long)v + j);
+			assert(strcmp(z, zWant) == 0);
+			free(z);
+			if (v + j > 2147483647LL)
+				continue;
+			snprintf(zWant, sizeof(zWant), "%d %u %x %o",
+			    (int)(v + j), (unsigned)(v + j), (unsigned)(v + j),
+			    (unsigned)(v + j));
+			z = mprintf("%d %u %x %o", (int)(v + j),
+			    (unsigned)(v + j), (unsigned)(v + j),
+			    (unsigned)(v + j));
+			assert(strcmp(z, zWant) == 0);
+			free(z);
+		}
+	}
+	/* Thousands separators */
+	z = mprintf("%,d|%,d|%,d|%,lld|%,u|%,12d|%-,12d|%,5d|%,08d|",
+	    0, 999, -1000, 18446744073709551LL, 4294967295u, 1234567,
+	    -1234567, 12, 1234);
+	assert(strcmp(z, "0|999|-1,000|18,446,744,073,709,551|4,294,967,295|"
+	    "   1,234,567|-1,234,567  |   12|00,001,234|") == 0);
+	free(z);
+}
+
 int
 main(void)
 {
@@ -81,6 +192,8 @@ main(void)
 		assert(strcmp(z, fmt[i].after) == 0);
 		free(z);
 	}
+	test_cache();
+	test_radix();
 
 	return (0);
 }
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+/*
+ * Integer conversions of vxprintf() against the one digit per division
+ * loop it used to have and against snprintf(), on values of mixed
+ * magnitude.  Not part of 'make test', run with 'make bench'.
+ */
+
+#include <time.h>
+
+#include "fslbase.h"
+
+#define NVAL	4096
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+/* The conversion loop of etRADIX before the base 10 and hex paths */
+static int
+old_loop(char *zEnd, unsigned long long v, int base, const char *cset)
+{
+	char *z = zEnd;
+
+	do {
+		*(--z) = cset[v % base];
+		v = v / base;
+	} while (v > 0);
+	return (zEnd - z);
+}
+
+static void
+appendf(Blob *pOut, const char *zFmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, zFmt);
+	vxprintf(pOut, zFmt, ap);
+	va_end(ap);
+}
+
+static void
+report(const char *zName, const char *zWhat, double t, int n)
+{
+	printf("%-10s %-10s %8.1f ns/value\n", zName, zWhat, t * 1e6 / n);
+}
+
+static void
+bench(const char *zWhat, const char *zFmt, int base, long long *aVal,
+    int nRound)
+{
+	Blob out = BLOB_INITIALIZER;
+	char buf[64];
+	double t;
+	int i, k;
+	unsigned long long sum = 0;
+
+	t = now();
+	for (k = 0; k < nRound; k++)
+		for (i = 0; i < NVAL; i++)
+			sum += old_loop(buf + sizeof(buf), aVal[i], base,
+			    "0123456789abcdef");
+	report("old loop", zWhat, now() - t, nRound * NVAL);
+
+	t = now();
+	for (k = 0; k < nRound; k++) {
+		blob_resize(&out, 0);
+		for (i = 0; i < NVAL; i++)
+			appendf(&out, zFmt, aVal[i]);
+	}
+	report("vxprintf", zWhat, now() - t, nRound * NVAL);
+	sum += blob_size(&out);
+
+	t = now();
+	for (k = 0; k < nRound; k++)
+		for (i = 0; i < NVAL; i++)
+			sum += snprintf(buf, sizeof(buf), zFmt, aVal[i]);
+	report("snprintf", zWhat, now() - t, nRound * NVAL);
+	blob_reset(&out);
+	if (sum == 0)
+		printf("no output\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	long long aVal[NVAL];
+	unsigned long long x = 88172645463325252ULL;
+	int i, nRound = 200;
+
+	if (argc > 1)
+		nRound = atoi(argv[1]);
+	/* xorshift values, cut to 1 to 19 digits */
+	for (i = 0; i < NVAL; i++) {
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		aVal[i] = (long long)(x >> (x % 60 + 1));
+	}
+	bench("%lld", "%lld", 10, aVal, nRound);
+	bench("%llx", "%llx", 16, aVal, nRound);
+	for (i = 0; i < NVAL; i++)
+		aVal[i] = (unsigned long long)aVal[i] % 100000;
+	bench("%d < 1e5", "%lld", 10, aVal, nRound);
+	return (0);
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+static size_t
+naive(const char *z, size_t n, int space)
+{
+	size_t i;
+
+	for (i = 0; i < n && fossil_isspace(z[i]) != space; i++)
+		;
+	return (i);
+}
+
+static long
+naive_find(const char *z, size_t n, const char *x, size_t m, int last)
+{
+	long i, found = -1;
+
+	for (i = 0; i + m <= n; i++) {
+		if (memcmp(z + i, x, m) == 0) {
+			found = i;
+			if (!last)
+				break;
+		}
+	}
+	return (found);
+}
+
+int
+main(void)
+{
+	Blob in, line, tok, aLine[4], a, b;
+	const char text[] = "one two\n\tthree  \r\nfour\n\nfive";
+	const char charset[] = " \t\n\v\f\rab\x85\xff";
+	char buf[300], needle[80];
+	size_t i, m, n;
+	long k;
+	int j;
+
+	cez_test_start();
+	/* every byte class at every offset crosses the vector paths */
+	srandom(1);
+	for (j = 0; j < 2000; j++) {
+		n = random() % sizeof(buf);
+		for (i = 0; i < n; i++)
+			buf[i] = charset[random() % (sizeof(charset) - 1)];
+		for (i = 0; i < n; i += 7) {
+			assert(scan_space(buf + i, n - i) ==
+			    naive(buf + i, n - i, 1));
+			assert(scan_nonspace(buf + i, n - i) ==
+			    naive(buf + i, n - i, 0));
+		}
+	}
+	memset(buf, 'x', sizeof(buf));
+	assert(scan_space(buf, sizeof(buf)) == sizeof(buf));
+	assert(scan_newline(buf, sizeof(buf)) == sizeof(buf));
+	buf[257] = '\n';
+	assert(scan_newline(buf, sizeof(buf)) == 257);
+	assert(scan_space(buf, sizeof(buf)) == 257);
+	assert(scan_nonspace(buf, 0) == 0);
+
+	/* blob_find() and blob_find_last() against a naive search */
+	for (j = 0; j < 3000; j++) {
+		n = random() % sizeof(buf);
+		m = 1 + random() % (j % 3 ? 4 : sizeof(needle));
+		for (i = 0; i < n; i++)
+			buf[i] = "ab\0"[random() % 3];
+		for (i = 0; i < m; i++)
+			needle[i] = "ab\0"[random() % 3];
+		if (n >= m && j % 2)
+			memcpy(buf + random() % (n - m + 1), needle, m);
+		blob_init(&in, buf, n);
+		in.iCursor = random() % (n + 1);
+		i = in.iCursor;
+		k = naive_find(buf + i, n - i, needle, m, 0);
+		assert(blob_find(&in, needle, m) == (k < 0 ? -1 : (long)i + k));
+		k = naive_find(buf + i, n - i, needle, m, 1);
+		assert(blob_find_last(&in, needle, m) ==
+		    (k < 0 ? -1 : (long)i + k));
+		k = naive_find(buf, n, needle, m, 1);
+		assert(scan_find_last(buf, n, needle, m) ==
+		    (k < 0 ? n : (size_t)k));
+	}
+	blob_init(&in, text, -1);
+	assert(blob_find(&in, "five", -1) == 24);
+	assert(blob_find(&in, "\n", 1) == 7);
+	assert(blob_find_last(&in, "\n", 1) == 23);
+	assert(blob_find(&in, "", 0) == 0);
+	assert(blob_find_last(&in, "", 0) == 28);
+	assert(blob_find(&in, "six", -1) == -1);
+	assert(blob_find_last(&in, "six", -1) == -1);
+	in.iCursor = 25;
+	assert(blob_find(&in, "five", -1) == -1);
+	assert(blob_buffer(&in) == text);
+
+	/* blob_compare(), blob_eq_str() and blob_eq() */
+	blob_init(&a, "abc\0d", 5);
+	blob_init(&b, "abc", 3);
+	assert(blob_compare(&a, &b) > 0);
+	assert(blob_compare(&b, &a) < 0);
+	assert(blob_compare(&a, &a) == 0);
+	assert(blob_eq_str(&a, "abc\0d", 5));
+	assert(!blob_eq_str(&a, "abc\0d", -1));
+	assert(blob_eq_str(&b, "abc", -1));
+	assert(blob_eq(&b, "abc"));
+	assert(!blob_eq(&b, "abd"));
+	blob_init(&b, "abd", 3);
+	assert(blob_compare(&a, &b) < 0);
+	blob_zero(&b);
+	assert(blob_compare(&b, &b) == 0);
+	assert(blob_compare(&b, &a) < 0);
+	assert(blob_eq(&b, ""));
+
+	/* blob_line() */
+	blob_init(&in, text, -1);
+	assert(blob_line(&in, &line) == 8);
+	assert(memcmp(blob_buffer(&line), "one two\n", 8) == 0);
+	assert(blob_buffer(&line) == text);
+	assert(blob_line(&in, &line) == 10);
+	assert(blob_trim(&line) == 6);
+	assert(memcmp(blob_buffer(&line), "\tthree", 6) == 0);
+	assert(blob_line(&in, &line) == 5);
+	assert(blob_line(&in, &line) == 1);
+	assert(blob_line(&in, &line) == 4);
+	assert(strcmp(blob_str(&line), "five") == 0);
+	blob_reset(&line);
+	assert(blob_line(&in, &line) == 0);
+	assert(blob_unread(&in) == 0);
+
+	/* blob_split_lines() */
+	blob_init(&in, text, -1);
+	assert(blob_split_lines(&in, aLine, 4) == 4);
+	assert(blob_size(&aLine[3]) == 1);
+	assert(blob_split_lines(&in, aLine, 4) == 1);
+	assert(memcmp(blob_buffer(&aLine[0]), "five", 4) == 0);
+	assert(blob_split_lines(&in, aLine, 4) == 0);
+
+	/* blob_token() */
+	blob_init(&in, text, -1);
+	assert(blob_token(&in, &tok) == 3);
+	assert(memcmp(blob_buffer(&tok), "one", 3) == 0);
+	assert(blob_token(&in, &tok) == 3);
+	assert(memcmp(blob_buffer(&tok), "two", 3) == 0);
+	assert(in.iCursor == 9);
+	assert(blob_token(&in, &tok) == 5);
+	assert(blob_token(&in, &tok) == 4);
+	assert(blob_token(&in, &tok) == 4);
+	assert(memcmp(blob_buffer(&tok), "five", 4) == 0);
+	assert(blob_token(&in, &tok) == 0);
+
+	/* long tokens */
+	memset(buf, ' ', sizeof(buf));
+	memset(buf + 40, 'y', 100);
+	blob_init(&in, buf, sizeof(buf));
+	assert(blob_token(&in, &tok) == 100);
+	assert(blob_buffer(&tok) == buf + 40);
+	assert(blob_unread(&in) == 0);
+	assert(blob_token(&in, &tok) == 0);
+	blob_init(&in, buf, 30);
+	assert(blob_trim(&in) == 0);
+
+	return (0);
+}
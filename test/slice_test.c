@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+int
+main(void)
+{
+	BlobSlice whole, head, tail, mid;
+	Blob b;
+	char buf[16];
+	char *z;
+
+	cez_test_start();
+	/* a malloc()ed blob is taken over without a copy */
+	b = empty_blob;
+	blob_append(&b, "hello, shared world", -1);
+	z = blob_buffer(&b);
+	blob_slice_init(&whole, &b);
+	assert(blob_buffer(&whole.b) == z);
+	assert(blob_size(&b) == 0);
+	assert(blob_slice_refs(&whole) == 1);
+
+	/* slices view the same bytes */
+	blob_slice(&head, &whole, 0, 5);
+	blob_slice(&tail, &whole, 14, 100);
+	blob_slice(&mid, &tail, 1, 3);
+	assert(blob_slice_refs(&whole) == 4);
+	assert(blob_buffer(&head.b) == z);
+	assert(blob_size(&head.b) == 5);
+	assert(blob_buffer(&tail.b) == z + 14);
+	assert(blob_size(&tail.b) == 5);
+	assert(blob_buffer(&mid.b) == z + 15);
+	assert(memcmp(blob_buffer(&mid.b), "orl", 3) == 0);
+	assert(blob_eq(&tail.b, "world"));
+
+	/* a write copies only that slice */
+	blob_append(&head.b, "!", 1);
+	assert(strcmp(blob_str(&head.b), "hello!") == 0);
+	assert(blob_buffer(&head.b) != z);
+	assert(blob_slice_refs(&head) == 0);
+	assert(blob_slice_refs(&whole) == 3);
+	assert(strcmp(blob_buffer(&whole.b), "hello, shared world") == 0);
+
+	/* blob_str() needs a terminator, so a mid slice is copied */
+	assert(strcmp(blob_str(&mid.b), "orl") == 0);
+	assert(blob_buffer(&mid.b) != z + 15);
+	assert(blob_slice_refs(&whole) == 2);
+	assert(z[18] == 'd');
+
+	/* a written slice is shared again when sliced */
+	blob_reset(&mid.b);
+	blob_slice(&mid, &head, 1, 2);
+	assert(blob_slice_refs(&head) == 2);
+	assert(memcmp(blob_buffer(&mid.b), "el", 2) == 0);
+	blob_slice(&mid, &mid, 1, 1);
+	assert(blob_eq(&mid.b, "l"));
+	assert(blob_slice_refs(&head) == 2);
+	blob_reset(&mid.b);
+	blob_reset(&head.b);
+
+	/* the last reference frees the buffer */
+	blob_resize(&whole.b, 5);
+	assert(blob_slice_refs(&tail) == 1);
+	assert(blob_eq(&whole.b, "hello"));
+	blob_reset(&whole.b);
+	assert(blob_eq(&tail.b, "world"));
+	blob_reset(&tail.b);
+
+	/* static content is copied once, then shared */
+	blob_init(&b, "static text", -1);
+	blob_slice_init(&whole, &b);
+	assert(blob_buffer(&whole.b) != blob_buffer(&b));
+	blob_slice(&head, &whole, 7, 4);
+	assert(blob_eq(&head.b, "text"));
+	blob_slice_init(&tail, &head.b);
+	assert(blob_size(&head.b) == 0);
+	assert(blob_slice_refs(&tail) == 2);
+	blob_reset(&whole.b);
+	blob_reset(&tail.b);
+
+	/* consuming from a slice leaves its siblings alone */
+	b = empty_blob;
+	blob_append(&b, "hello world", -1);
+	blob_slice_init(&whole, &b);
+	z = blob_buffer(&whole.b);
+	blob_slice(&head, &whole, 0, 5);
+	blob_slice(&tail, &whole, 6, 5);
+	assert(blob_consume(&head.b, buf, 5) == 5);
+	assert(memcmp(buf, "hello", 5) == 0);
+	assert(blob_size(&head.b) == 0);
+	assert(blob_consume(&tail.b, buf, 2) == 2);
+	blob_compact(&tail.b);
+	assert(blob_buffer(&tail.b) == z + 8);
+	assert(blob_eq(&tail.b, "rld"));
+	assert(blob_slice_refs(&whole) == 3);
+	assert(memcmp(z, "hello world", 11) == 0);
+	assert(blob_eq(&whole.b, "hello world"));
+	blob_reset(&head.b);
+	blob_reset(&tail.b);
+	blob_reset(&whole.b);
+
+	/* empty blobs */
+	b = empty_blob;
+	blob_slice_init(&whole, &b);
+	assert(blob_size(&whole.b) == 0);
+	assert(strcmp(blob_str(&whole.b), "") == 0);
+	blob_slice(&head, &whole, 3, 3);
+	assert(blob_size(&head.b) == 0);
+	blob_append(&head.b, "x", 1);
+	assert(blob_eq(&head.b, "x"));
+	blob_reset(&head.b);
+	blob_reset(&whole.b);
+
+	return (0);
+}
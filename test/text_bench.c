@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Throughput of the text checks over multi-megabyte inputs.  Build the
+ * library with 'make -DNOSIMD' to compare with the portable code.  Not
+ * part of 'make test', run with 'make bench'.
+ */
+
+#include <time.h>
+
+#include "fslbase.h"
+
+#define NBYTE		(16 << 20)	/* size of each input */
+#define NLOOP		8		/* passes over each input */
+
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+static void
+report(const char *zName, double t)
+{
+	printf("%-24s %8.0f MB/s\n", zName, (double)NBYTE * NLOOP / 1e3 / t);
+}
+
+/*
+ * Fill pOut with NBYTE bytes of source code lines, with CRLF endings if
+ * crlf is set and with a few multi-byte characters if utf8 is set.
+ */
+static void
+make_text(Blob *pOut, int crlf, int utf8)
+{
+	int i;
+
+	*pOut = empty_blob;
+	for (i = 0; blob_size(pOut) < NBYTE; i++) {
+		blob_append_sql(pOut, "\tif( p->nUsed>%d ) blob_append(p, z, %d);"
+		    " /* %s */%s", i % 977, i % 31,
+		    utf8 ? "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80" : "ok",
+		    crlf ? "\r\n" : "\n");
+	}
+	blob_resize(pOut, NBYTE);
+}
+
+int
+main(void)
+{
+	Blob ascii, utf8, crlf, work;
+	double t;
+	int i, ok = 0;
+
+	make_text(&ascii, 0, 0);
+	make_text(&utf8, 0, 1);
+	make_text(&crlf, 1, 0);
+	printf("%d MB inputs, %d passes\n", NBYTE >> 20, NLOOP);
+
+	t = now();
+	for (i = 0; i < NLOOP; i++)
+		ok += blob_is_utf8(&ascii);
+	report("blob_is_utf8 ascii", now() - t);
+	t = now();
+	for (i = 0; i < NLOOP; i++)
+		ok += blob_is_utf8(&utf8);
+	report("blob_is_utf8 mixed", now() - t);
+
+	t = 0;
+	for (i = 0; i < NLOOP; i++) {
+		work = empty_blob;
+		blob_append(&work, blob_buffer(&crlf), blob_size(&crlf));
+		t -= now();
+		blob_to_lf_only(&work);
+		t += now();
+		blob_reset(&work);
+	}
+	report("blob_to_lf_only crlf", t);
+	t = 0;
+	for (i = 0; i < NLOOP; i++) {
+		work = empty_blob;
+		blob_append(&work, blob_buffer(&crlf), blob_size(&crlf));
+		t -= now();
+		blob_remove_cr(&work);
+		t += now();
+		blob_reset(&work);
+	}
+	report("blob_remove_cr crlf", t);
+	t = now();
+	for (i = 0; i < NLOOP; i++)
+		blob_to_lf_only(&ascii);
+	report("blob_to_lf_only lf", now() - t);
+
+	memset(blob_buffer(&crlf), ' ', NBYTE);
+	t = now();
+	for (i = 0; i < NLOOP; i++)
+		ok += fossil_all_whitespace(blob_buffer(&crlf));
+	report("fossil_all_whitespace", now() - t);
+
+	if (ok != 3 * NLOOP)
+		printf("unexpected result %d\n", ok);
+	blob_reset(&ascii);
+	blob_reset(&utf8);
+	blob_reset(&crlf);
+
+	return (0);
+}
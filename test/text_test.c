@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2026 Nikola Kolev <koue@chaosophia.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    - Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    - Redistributions in binary form must reproduce the above
+ *      copyright notice, this list of conditions and the following
+ *      disclaimer in the documentation and/or other materials provided
+ *      with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "fslbase.h"
+#include "cez_test.h"
+
+/* Decode each character and check its value against its length. */
+static int
+naive_utf8(const unsigned char *z, size_t n)
+{
+	static const unsigned long min[] = { 0, 0x80, 0x800, 0x10000 };
+	unsigned long c;
+	size_t i, k, len;
+
+	for (i = 0; i < n; i += len) {
+		if (z[i] < 0x80)
+			len = 1, c = z[i];
+		else if ((z[i] & 0xe0) == 0xc0)
+			len = 2, c = z[i] & 0x1f;
+		else if ((z[i] & 0xf0) == 0xe0)
+			len = 3, c = z[i] & 0x0f;
+		else if ((z[i] & 0xf8) == 0xf0)
+			len = 4, c = z[i] & 0x07;
+		else
+			return (0);
+		if (i + len > n)
+			return (0);
+		for (k = 1; k < len; k++) {
+			if ((z[i + k] & 0xc0) != 0x80)
+				return (0);
+			c = c << 6 | (z[i + k] & 0x3f);
+		}
+		if (c < min[len - 1] || c > 0x10ffff ||
+		    (c >= 0xd800 && c <= 0xdfff))
+			return (0);
+	}
+	return (1);
+}
+
+static size_t
+put_utf8(unsigned char *z, unsigned long c)
+{
+	if (c < 0x80) {
+		z[0] = c;
+		return (1);
+	}
+	if (c < 0x800) {
+		z[0] = 0xc0 | c >> 6;
+		z[1] = 0x80 | (c & 0x3f);
+		return (2);
+	}
+	if (c < 0x10000) {
+		z[0] = 0xe0 | c >> 12;
+		z[1] = 0x80 | (c >> 6 & 0x3f);
+		z[2] = 0x80 | (c & 0x3f);
+		return (3);
+	}
+	z[0] = 0xf0 | c >> 18;
+	z[1] = 0x80 | (c >> 12 & 0x3f);
+	z[2] = 0x80 | (c >> 6 & 0x3f);
+	z[3] = 0x80 | (c & 0x3f);
+	return (4);
+}
+
+static size_t
+naive_cr(char *z, size_t n, int to_lf)
+{
+	size_t i, j;
+
+	for (i = j = 0; i < n; i++) {
+		if (z[i] == '\r') {
+			if (!to_lf || (i + 1 < n && z[i + 1] == '\n'))
+				continue;
+			z[j++] = '\n';
+		} else
+			z[j++] = z[i];
+	}
+	return (j);
+}
+
+int
+main(void)
+{
+	static const unsigned long limit[] = { 0x80, 0x800, 0x10000, 0x110000 };
+	static const char *bad[] = {
+		"\x80", "\xc0\x80", "\xc1\xbf", "\xe0\x9f\xbf", "\xed\xa0\x80",
+		"\xf0\x8f\xbf\xbf", "\xf4\x90\x80\x80", "\xf5\x80\x80\x80",
+		"\xff", "\xc3", "\xe2\x82", "\xf0\x9f\x98", "\xc3\xa9\xa9",
+	};
+	Blob b;
+	unsigned char buf[400], ref[400];
+	const char *z;
+	size_t i, k, n;
+	unsigned long c;
+	int j;
+
+	cez_test_start();
+	/* blob_is_utf8() on valid text, then with one byte changed */
+	srandom(1);
+	for (j = 0; j < 20000; j++) {
+		n = 0;
+		k = 1 + random() % 300;
+		while (n < k) {
+			c = random() % limit[random() % 4];
+			if (c >= 0xd800 && c <= 0xdfff)
+				continue;
+			n += put_utf8(buf + n, c);
+		}
+		if (j % 2)
+			buf[random() % n] = random();
+		blob_init(&b, (char *)buf, n);
+		assert(blob_is_utf8(&b) == naive_utf8(buf, n));
+		for (i = 1; i < n; i += 13) {
+			blob_init(&b, (char *)buf + i, n - i);
+			assert(blob_is_utf8(&b) == naive_utf8(buf + i, n - i));
+		}
+	}
+	/* every error class at every offset of a block */
+	for (j = 0; j < (int)(sizeof(bad) / sizeof(bad[0])); j++) {
+		for (i = 0; i < 70; i++) {
+			memset(buf, 'a', sizeof(buf));
+			memcpy(buf + i, bad[j], strlen(bad[j]));
+			blob_init(&b, (char *)buf, 100);
+			assert(!blob_is_utf8(&b));
+			blob_init(&b, (char *)buf, i + strlen(bad[j]));
+			assert(!blob_is_utf8(&b));
+		}
+	}
+	blob_init(&b, "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\0x", 15);
+	assert(blob_is_utf8(&b));
+	blob_zero(&b);
+	assert(blob_is_utf8(&b));
+
+	/* blob_remove_cr() and blob_to_lf_only() against a naive loop */
+	for (j = 0; j < 4000; j++) {
+		n = 1 + random() % 300;
+		for (i = 0; i < n; i++)
+			buf[i] = "\r\r\nab"[random() % (j % 2 ? 5 : 3)];
+		memcpy(ref, buf, n);
+		k = naive_cr((char *)ref, n, j % 4 < 2);
+		blob_init(&b, (char *)buf, n);
+		if (j % 4 < 2)
+			blob_to_lf_only(&b);
+		else
+			blob_remove_cr(&b);
+		assert(blob_size(&b) == k);
+		assert(memcmp(blob_buffer(&b), ref, k) == 0);
+		assert(k == n || blob_buffer(&b)[k] == 0);
+		blob_reset(&b);
+	}
+	z = "no carriage return";
+	blob_init(&b, z, -1);
+	blob_to_lf_only(&b);
+	assert(blob_buffer(&b) == z);
+	blob_init(&b, "a\r\nb\rc\r", -1);
+	blob_to_lf_only(&b);
+	assert(strcmp(blob_buffer(&b), "a\nb\nc\n") == 0);
+	blob_reset(&b);
+	blob_init(&b, "a\r\nb\rc\r", -1);
+	blob_remove_cr(&b);
+	assert(strcmp(blob_buffer(&b), "a\nbc") == 0);
+	blob_reset(&b);
+
+	/* fossil_all_whitespace() */
+	memset(buf, ' ', sizeof(buf));
+	buf[sizeof(buf) - 1] = 0;
+	assert(fossil_all_whitespace((char *)buf));
+	assert(fossil_all_whitespace(""));
+	assert(fossil_all_whitespace(NULL));
+	buf[333] = 'x';
+	assert(!fossil_all_whitespace((char *)buf));
+	assert(!fossil_all_whitespace(" \t\r\n."));
+
+	return (0);
+}